@@ -0,0 +1,103 @@
+/**
+  ******************************************************************************
+  * @file    host.h
+  * @author  정두원
+  * @date    2020-12-28
+  * @brief   호스트 빌드용 CMSIS 명령어 대체
+  * @details 모든 소스에 -include 로 먼저 포함. cmsis_gcc.h 의 포함 가드를 먼저 정의하여 ARM 어셈블리
+  *          명령어 대신 호스트에서 동작하는 함수를 사용. 인터럽트는 시뮬레이터가 __WFI() 등 대기 함수
+  *          안에서만 호출하므로 PRIMASK 는 값만 기록.
+  */
+
+#ifndef HOST_H__
+#define HOST_H__ 1
+
+#include <stdint.h>
+
+#define __CMSIS_GCC_H /* Drivers/CMSIS/Include/cmsis_gcc.h 대신 사용 */
+
+#ifndef __has_builtin
+#define __has_builtin(x) (0)
+#endif
+
+#define __ASM __asm
+#define __INLINE inline
+#define __STATIC_INLINE static inline
+#define __STATIC_FORCEINLINE __attribute__((always_inline)) static inline
+#define __NO_RETURN __attribute__((__noreturn__))
+#define __USED __attribute__((used))
+#define __WEAK __attribute__((weak))
+#define __PACKED __attribute__((packed, aligned(1)))
+#define __PACKED_STRUCT struct __attribute__((packed, aligned(1)))
+#define __PACKED_UNION union __attribute__((packed, aligned(1)))
+#define __ALIGNED(x) __attribute__((aligned(x)))
+#define __RESTRICT __restrict
+#define __COMPILER_BARRIER() __ASM volatile("" ::: "memory")
+
+/* Extern functions ---------------------------------------------------------*/
+void Host_WaitForInterrupt(void); /*!< 다음 인터럽트까지 가상 시간을 넘기고 인터럽트 처리 (Host/Sim/board.c) */
+
+extern volatile uint32_t Host_Primask; /*!< 1: 인터럽트 금지 */
+
+__STATIC_FORCEINLINE void __enable_irq(void)
+{
+    Host_Primask = 0U;
+}
+
+__STATIC_FORCEINLINE void __disable_irq(void)
+{
+    Host_Primask = 1U;
+}
+
+__STATIC_FORCEINLINE uint32_t __get_PRIMASK(void)
+{
+    return Host_Primask;
+}
+
+__STATIC_FORCEINLINE void __set_PRIMASK(uint32_t priMask)
+{
+    Host_Primask = priMask;
+}
+
+__STATIC_FORCEINLINE void __DMB(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+__STATIC_FORCEINLINE void __DSB(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+__STATIC_FORCEINLINE void __ISB(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+__STATIC_FORCEINLINE uint32_t __RBIT(uint32_t value)
+{
+    uint32_t result = 0U;
+
+    for (uint32_t i = 0; i < 32U; i++)
+    {
+        result = (result << 1) | ((value >> i) & 1U);
+    }
+    return result;
+}
+
+__STATIC_FORCEINLINE uint8_t __CLZ(uint32_t value)
+{
+    return (value == 0U) ? 32U : (uint8_t)__builtin_clz(value);
+}
+
+__STATIC_FORCEINLINE uint32_t __REV(uint32_t value)
+{
+    return __builtin_bswap32(value);
+}
+
+#define __NOP() __COMPILER_BARRIER()
+#define __WFI() Host_WaitForInterrupt()
+#define __WFE() Host_WaitForInterrupt()
+#define __SEV() __COMPILER_BARRIER()
+
+#endif /* HOST_H__ */
@@ -0,0 +1,997 @@
+/**
+  ******************************************************************************
+  * @file    board.c
+  * @author  정두원
+  * @date    2020-12-28
+  * @brief   호스트 시뮬레이션 보드 (HAL 대체)
+  * @details User 계층이 쓰는 HAL 함수를 대신하고, 레지스터를 직접 쓰는 주변장치(LPTIM1, DWT, DMA CNDTR,
+  *          USART CR1 등)는 실제 주소에 메모리를 매핑하여 그대로 읽고 씀. 플래시(0x08000000)는 공유
+  *          메모리로 매핑하여 주기(프로세스) 사이에 유지.
+  *
+  *          시간은 가상 시각으로만 흐름. __WFI(), Stop 1 모드에서는 다음 인터럽트 시각(LPTIM1 비교 일치,
+  *          카운터 한 바퀴, UART 송수신 완료, IDLE, ADC 완료)으로 바로 넘어가 해당 인터럽트 함수를 호출하고,
+  *          HAL_Delay(), 플래시 쓰기, 지우기는 그 시간만큼 CPU 동작 시간으로 기록.
+  *          HAL_PWR_EnterSTANDBYMode() 가 한 주기의 끝.
+  */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "sim.h"
+#include "usart.h"
+#include "rtc.h"
+#include "adc.h"
+#include "uart.h"
+
+/** @defgroup BOARD 시뮬레이션 보드
+  * @brief HAL 대체, 가상 시간, 인터럽트
+  * @{
+  */
+
+#define BOARD_FLASH_SIZE 0x20000U    /*!< 플래시 128K */
+#define BOARD_PERIPH_SIZE 0x30000U   /*!< APB1, APB2, AHB1 (LPTIM1, USART, DMA, RCC, FLASH 레지스터) */
+#define BOARD_CORE_BASE 0xE0000000UL /*!< DWT, SCB, NVIC */
+#define BOARD_CORE_SIZE 0x100000U
+#define BOARD_EVENT_MAX 64U          /*!< 대기 중인 인터럽트 최대 갯수 */
+#define BOARD_CPU_MHZ 32U            /*!< MSI 32MHz. DWT 사이클 카운터 증가량 */
+#define BOARD_ADC_TIME 40U           /*!< ADC 3채널 변환 시간. 단위 us */
+#define BOARD_FLASH_PROGRAM_TIME 82U /*!< 더블워드 쓰기 시간. 단위 us */
+#define BOARD_FLASH_ERASE_TIME 22000U /*!< 페이지 지우기 시간. 단위 us */
+#define BOARD_ADC_BATTERY 2300U      /*!< 배터리 ADC 코드 */
+
+typedef enum
+{
+    BOARD_EVENT_RX = 0, /*!< 상대 장치 송신 묶음 수신 완료 (DMA) */
+    BOARD_EVENT_IDLE,   /*!< 수신 라인 IDLE */
+    BOARD_EVENT_TX,     /*!< DMA 송신 완료 */
+    BOARD_EVENT_ADC     /*!< ADC 변환 완료 */
+} boardEventType;
+
+typedef struct
+{
+    bool used;
+    boardEventType type;
+    uint8_t uart;     /*!< 0: USART1, 1: USART2 */
+    uint64_t time;    /*!< 발생 시각. 단위 us */
+    uint64_t start;   /*!< 수신 묶음 전송 시작 시각. 단위 us */
+    uint32_t order;   /*!< 같은 시각이면 먼저 등록한 것부터 */
+    uint32_t baud;    /*!< 상대 장치 통신 속도 */
+    uint16_t length;
+    const uint8_t *data;
+    uint8_t *copy;    /*!< 수신 데이터 사본 */
+} boardEvent_TypeDef; /*!< 예약된 인터럽트 */
+
+typedef struct
+{
+    UART_HandleTypeDef *huart;
+    uint8_t *rxData;     /*!< DMA 수신 버퍼 */
+    uint16_t rxSize;
+    uint16_t rxPos;      /*!< DMA 쓰기 위치 */
+    bool rxActive;
+    uint64_t rxLineFree; /*!< 상대 장치 송신이 끝나는 시각 */
+    uint64_t txLineFree; /*!< 송신이 끝나는 시각 */
+    bool txBusy;
+} boardUart_TypeDef;
+
+/* Handles (Core/Src 대신) ---------------------------------------------------*/
+UART_HandleTypeDef huart1;
+UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart1_rx;
+DMA_HandleTypeDef hdma_usart1_tx;
+DMA_HandleTypeDef hdma_usart2_rx;
+DMA_HandleTypeDef hdma_usart2_tx;
+RTC_HandleTypeDef hrtc;
+ADC_HandleTypeDef hadc1;
+
+uint32_t SystemCoreClock = BOARD_CPU_MHZ * 1000000U;
+__IO uint32_t uwTick;
+volatile uint32_t Host_Primask;
+
+simShared_TypeDef *simShared;
+simBoard_TypeDef simBoard = {.bootCost = 2000U, .wakeCost = 30U, .adcDevice = 2048U, .adcNoise = 8U, .adcVref = 1490U, .din = 0U};
+
+extern uint8_t __retained_start[]; /*!< Host/Sim/sim.ld */
+extern uint8_t __retained_end[];
+
+void LPTIM1_IRQHandler(void); /*!< timebase.c */
+
+/* Private variables ---------------------------------------------------------*/
+static boardEvent_TypeDef events[BOARD_EVENT_MAX];
+static uint32_t eventOrder;
+static boardUart_TypeDef uarts[SIM_UART_COUNT] = {{.huart = &huart1}, {.huart = &huart2}};
+static bool lptimRunning;   /*!< LPTIM1 카운터 시작됨 */
+static uint64_t lptimStart; /*!< 카운터 시작 시각 */
+static uint64_t cycleStart; /*!< 깨어난 시각 */
+static uint16_t *adcData;   /*!< ADC DMA 버퍼 */
+static bool flashLocked = true;
+static bool sram2Retention;
+static bool wakeupSet;
+static bool modemPower;
+static bool buttonPressed;   /*!< 부팅 시 사용자 버튼 누름. 처음 한 번 읽을 때만 */
+static uint32_t randomState;
+
+/* Private functions ---------------------------------------------------------*/
+static void *mapFixed(uintptr_t address, size_t size, int flags);
+static void passTime(uint64_t delta, simMode mode);
+static void runFor(uint64_t delta);
+static void waitForInterrupt(simMode mode);
+static int nextEvent(uint64_t *when);
+static void deliver(int index);
+static uint64_t lptimTicks(void);
+static uint64_t nextCompare(uint64_t ticks);
+static uint32_t lptimPending(void);
+static void deliverRx(boardEvent_TypeDef *event);
+static boardEvent_TypeDef *addEvent(boardEventType type, uint8_t uart, uint64_t time);
+static uint64_t byteTime(uint32_t length, uint32_t baud);
+static bool isLineBusy(uint8_t uart);
+static boardUart_TypeDef *uartOf(UART_HandleTypeDef *huart);
+
+/**
+ * @brief 플래시, 주변장치, 코어 레지스터 주소에 메모리 매핑. 첫 주기 전에 1회 호출.
+ *        플래시는 지운 상태(0xFF)로 시작.
+ *
+ */
+void Board_Map(void)
+{
+    uint8_t *flash = mapFixed(FLASH_BASE, BOARD_FLASH_SIZE, MAP_SHARED);
+
+    memset(flash, 0xFF, BOARD_FLASH_SIZE);
+    (void)mapFixed(PERIPH_BASE, BOARD_PERIPH_SIZE, MAP_PRIVATE);
+    (void)mapFixed(BOARD_CORE_BASE, BOARD_CORE_SIZE, MAP_PRIVATE);
+
+    huart1.Instance = USART1;
+    huart1.Init.BaudRate = 115200U;
+    huart1.hdmarx = &hdma_usart1_rx;
+    huart1.hdmatx = &hdma_usart1_tx;
+    hdma_usart1_rx.Instance = DMA1_Channel5;
+    hdma_usart1_tx.Instance = DMA1_Channel4;
+    huart2.Instance = USART2;
+    huart2.Init.BaudRate = 115200U;
+    huart2.hdmarx = &hdma_usart2_rx;
+    huart2.hdmatx = &hdma_usart2_tx;
+    hdma_usart2_rx.Instance = DMA1_Channel6;
+    hdma_usart2_tx.Instance = DMA1_Channel7;
+    hrtc.Instance = RTC;
+    hadc1.Instance = ADC1;
+
+    LPTIM1->ISR = LPTIM_ISR_ARROK | LPTIM_ISR_CMPOK; /* 레지스터 쓰기 동기화는 바로 완료 */
+}
+
+/**
+ * @brief 깨어남. Board_Map() 후 fork 한 프로세스에서 호출하므로 주변장치, RAM 은 리셋 상태.
+ *        SRAM2 는 스탠바이 전에 유지 설정했으면 복원하고 아니면 임의 값.
+ *
+ */
+void Board_Reset(void)
+{
+    size_t size = (size_t)(__retained_end - __retained_start);
+
+    randomState = (simShared->seed ^ (simShared->cycle * 0x9E3779B9U)) | 1U;
+    cycleStart = simShared->now;
+    memset(&simShared->result, 0, sizeof(simShared->result));
+    simShared->result.start = cycleStart;
+    simShared->result.end = SIM_END_CRASH; /* Board_End() 없이 종료 */
+
+    if (size > SIM_SRAM2_MAX)
+    {
+        fprintf(stderr, "sim: .retained section %zu bytes exceeds SRAM2\n", size);
+        exit(1);
+    }
+    if (simShared->sram2Kept)
+    {
+        memcpy(__retained_start, simShared->sram2, size);
+    }
+    else
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            __retained_start[i] = (uint8_t)Board_Random();
+        }
+    }
+
+    for (uint8_t i = 0; i < simBoard.debugCount; i++) /* 버튼으로 깨어 있게 하고 DEBUG 포트 입력 */
+    {
+        const simDebug_TypeDef *debug = &simBoard.debug[i];
+        char text[SIM_DEBUG_TEXT_MAX + 2U];
+        int length;
+
+        if (debug->cycle == simShared->cycle)
+        {
+            buttonPressed = true;
+            length = snprintf(text, sizeof(text), "%s\r\n", debug->text);
+            Board_Receive(1U, (const uint8_t *)text, (uint16_t)length, huart2.Init.BaudRate, cycleStart + ((uint64_t)debug->delay * 1000U));
+        }
+    }
+
+    ModemSim_Reset();
+    passTime(simBoard.bootCost, SIM_MODE_RUN); /* 스탠바이 해제, 클럭 설정, 주변장치 초기화 */
+}
+
+/**
+ * @brief 가상 시각
+ *
+ * @return uint64_t: 단위 us
+ */
+uint64_t Board_Now(void)
+{
+    return simShared->now;
+}
+
+/**
+ * @brief 상대 장치가 보낸 데이터. 라인이 비는 시각부터 바이트 단위 시간 후 DMA 수신 완료.
+ *        통신 속도가 다르면 깨진 데이터와 프레이밍 에러로 수신.
+ *
+ * @param uart: 0: USART1, 1: USART2
+ * @param data: 보낸 데이터
+ * @param length: 길이
+ * @param baud: 상대 장치 통신 속도
+ * @param at: 송신 시작 시각. 단위 us
+ */
+void Board_Receive(uint8_t uart, const uint8_t *data, uint16_t length, uint32_t baud, uint64_t at)
+{
+    boardUart_TypeDef *u = &uarts[uart];
+    uint64_t start = (at > u->rxLineFree) ? at : u->rxLineFree;
+    boardEvent_TypeDef *event;
+
+    if (length == 0U)
+    {
+        return;
+    }
+    u->rxLineFree = start + byteTime(length, baud);
+    event = addEvent(BOARD_EVENT_RX, uart, u->rxLineFree);
+    event->start = start;
+    event->baud = baud;
+    event->length = length;
+    event->copy = malloc(length);
+    memcpy(event->copy, data, length);
+}
+
+/**
+ * @brief 난수 (xorshift32). 주기마다 시드에서 다시 시작하므로 같은 시드면 같은 결과.
+ *
+ * @return uint32_t: 난수
+ */
+uint32_t Board_Random(void)
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+/**
+ * @brief 주기 종료. 결과를 공유 메모리에 두고 프로세스 종료.
+ *
+ * @param end: 종료 원인
+ */
+void Board_End(simEnd end)
+{
+    simShared->result.end = end;
+    fflush(stdout);
+    _exit(0);
+}
+
+/* Time --------------------------------------------------------------------*/
+
+/**
+ * @brief HAL_GetTick() 이 LPTIM1 으로 바뀌기 전의 HAL 시간 기준 시작
+ */
+HAL_StatusTypeDef HAL_InitTick(uint32_t TickPriority)
+{
+    return HAL_OK;
+}
+
+/**
+ * @brief HAL_Delay(). 대기 시간만큼 CPU 동작. HAL 과 같이 1ms 더 대기.
+ */
+void HAL_Delay(uint32_t Delay)
+{
+    runFor(((uint64_t)Delay + 1U) * 1000U);
+}
+
+/**
+ * @brief SysTick 정지. LPTIM1 시작 후 호출됨
+ */
+void HAL_SuspendTick(void)
+{
+}
+
+/**
+ * @brief __WFI(). 다음 인터럽트까지 Sleep
+ */
+void Host_WaitForInterrupt(void)
+{
+    waitForInterrupt(SIM_MODE_SLEEP);
+}
+
+/* Power -------------------------------------------------------------------*/
+
+void HAL_PWREx_EnterSTOP1Mode(uint8_t STOPEntry)
+{
+    waitForInterrupt(SIM_MODE_STOP);
+}
+
+/**
+ * @brief 스탠바이 진입. 주기의 끝. SRAM2 유지 설정이면 .retained 섹션 보관.
+ */
+void HAL_PWR_EnterSTANDBYMode(void)
+{
+    size_t size = (size_t)(__retained_end - __retained_start);
+
+    if (!wakeupSet)
+    {
+        Board_End(SIM_END_NO_WAKEUP);
+    }
+    simShared->sram2Kept = sram2Retention;
+    if (sram2Retention)
+    {
+        memcpy(simShared->sram2, __retained_start, size);
+    }
+    Board_End(SIM_END_STANDBY);
+}
+
+void HAL_PWREx_EnableSRAM2ContentRetention(void)
+{
+    sram2Retention = true;
+}
+
+void HAL_PWREx_DisableSRAM2ContentRetention(void)
+{
+    sram2Retention = false;
+}
+
+void HAL_PWREx_EnableBORPVD_ULP(void)
+{
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+}
+
+uint32_t HAL_GetUIDw0(void)
+{
+    return 0x00350041U;
+}
+
+uint32_t HAL_GetUIDw1(void)
+{
+    return 0x31385106U;
+}
+
+uint32_t HAL_GetUIDw2(void)
+{
+    return 0x20333233U;
+}
+
+/* RTC ---------------------------------------------------------------------*/
+
+uint32_t HAL_RTCEx_BKUPRead(RTC_HandleTypeDef *handle, uint32_t BackupRegister)
+{
+    return simShared->backup[BackupRegister];
+}
+
+void HAL_RTCEx_BKUPWrite(RTC_HandleTypeDef *handle, uint32_t BackupRegister, uint32_t Data)
+{
+    simShared->backup[BackupRegister] = Data;
+}
+
+/**
+ * @brief 깨어남 타이머. CK_SPRE(1Hz) 로 WakeUpCounter + 1 초 후 깨어남.
+ */
+HAL_StatusTypeDef HAL_RTCEx_SetWakeUpTimer_IT(RTC_HandleTypeDef *handle, uint32_t WakeUpCounter, uint32_t WakeUpClock, uint32_t WakeUpAutoClr)
+{
+    simShared->result.standby = WakeUpCounter + 1U;
+    wakeupSet = true;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RTCEx_DeactivateWakeUpTimer(RTC_HandleTypeDef *handle)
+{
+    wakeupSet = false;
+    return HAL_OK;
+}
+
+/* GPIO --------------------------------------------------------------------*/
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+}
+
+/**
+ * @brief 입력. USER_BTN 은 DEBUG 포트 입력이 있는 주기에 처음 한 번만 누름(Low), 이후 뗌(High).
+ *        DIN 은 시나리오의 din 값.
+ */
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    static GPIO_TypeDef *const dinPort[4] = {DIN0_GPIO_Port, DIN1_GPIO_Port, DIN2_GPIO_Port, DIN3_GPIO_Port};
+    static const uint16_t dinPin[4] = {DIN0_Pin, DIN1_Pin, DIN2_Pin, DIN3_Pin};
+
+    if ((GPIOx == USER_BTN_GPIO_Port) && (GPIO_Pin == USER_BTN_Pin))
+    {
+        if (buttonPressed) /* 패스스루 모드가 되지 않게 바로 뗌 */
+        {
+            buttonPressed = false;
+            return GPIO_PIN_RESET;
+        }
+        return GPIO_PIN_SET;
+    }
+    for (uint8_t i = 0; i < 4U; i++)
+    {
+        if ((GPIOx == dinPort[i]) && (GPIO_Pin == dinPin[i]))
+        {
+            return ((simBoard.din >> i) & 1U) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+        }
+    }
+    return GPIO_PIN_RESET;
+}
+
+/**
+ * @brief 출력. LTE_WAKEUP 은 LTE 모뎀 전원.
+ */
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    if ((GPIOx == LTE_WAKEUP_GPIO_Port) && (GPIO_Pin == LTE_WAKEUP_Pin) && (modemPower != (PinState == GPIO_PIN_SET)))
+    {
+        modemPower = (PinState == GPIO_PIN_SET);
+        ModemSim_Power(modemPower);
+    }
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+}
+
+/* ADC ---------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef *hadc, uint32_t SingleDiff)
+{
+    runFor(10U);
+    return HAL_OK;
+}
+
+/**
+ * @brief ADC 3채널 변환 시작. BOARD_ADC_TIME 후 [0] 배터리, [1] 외부 디바이스, [2] VREFINT 채우고 완료 인터럽트.
+ */
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length)
+{
+    adcData = (uint16_t *)pData;
+    (void)addEvent(BOARD_EVENT_ADC, 0U, simShared->now + BOARD_ADC_TIME);
+    return HAL_OK;
+}
+
+/* Flash -------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void)
+{
+    flashLocked = false;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void)
+{
+    flashLocked = true;
+    return HAL_OK;
+}
+
+/**
+ * @brief 더블워드 쓰기. 지워지지 않은 자리에 쓰면 PROGERR.
+ */
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+    uint64_t *target = (uint64_t *)(uintptr_t)Address;
+
+    if (flashLocked || (TypeProgram != FLASH_TYPEPROGRAM_DOUBLEWORD) || ((Address & 7U) != 0U) ||
+        (Address < FLASH_BASE) || (Address >= (FLASH_BASE + BOARD_FLASH_SIZE)))
+    {
+        return HAL_ERROR;
+    }
+    if (*target != UINT64_MAX)
+    {
+        FLASH->SR |= FLASH_SR_PROGERR;
+        return HAL_ERROR;
+    }
+    *target = Data;
+    runFor(BOARD_FLASH_PROGRAM_TIME);
+    return HAL_OK;
+}
+
+/**
+ * @brief 페이지 지우기
+ */
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *PageError)
+{
+    *PageError = 0xFFFFFFFFU;
+    if (flashLocked || ((pEraseInit->Page + pEraseInit->NbPages) > (BOARD_FLASH_SIZE / FLASH_PAGE_SIZE)))
+    {
+        return HAL_ERROR;
+    }
+    memset((void *)(uintptr_t)(FLASH_BASE + (pEraseInit->Page * FLASH_PAGE_SIZE)), 0xFF, pEraseInit->NbPages * FLASH_PAGE_SIZE);
+    runFor((uint64_t)BOARD_FLASH_ERASE_TIME * pEraseInit->NbPages);
+    return HAL_OK;
+}
+
+/* UART --------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart)
+{
+    huart->gState = HAL_UART_STATE_READY;
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_StopModeWakeUpSourceConfig(UART_HandleTypeDef *huart, UART_WakeUpTypeDef WakeUpSelection)
+{
+    return HAL_OK;
+}
+
+/**
+ * @brief Circular DMA 수신 시작
+ */
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    boardUart_TypeDef *u = uartOf(huart);
+
+    u->rxData = pData;
+    u->rxSize = Size;
+    u->rxPos = 0U;
+    u->rxActive = true;
+    huart->hdmarx->Instance->CNDTR = Size;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    return HAL_OK;
+}
+
+/**
+ * @brief DMA 송신. 라인이 비는 시각부터 바이트 단위 시간 후 완료 인터럽트.
+ */
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    boardUart_TypeDef *u = uartOf(huart);
+    uint64_t start = (simShared->now > u->txLineFree) ? simShared->now : u->txLineFree;
+    boardEvent_TypeDef *event;
+
+    if (u->txBusy)
+    {
+        return HAL_BUSY;
+    }
+    u->txBusy = true;
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    u->txLineFree = start + byteTime(Size, huart->Init.BaudRate);
+    event = addEvent(BOARD_EVENT_TX, (uint8_t)(u - uarts), u->txLineFree);
+    event->data = pData;
+    event->length = Size;
+    event->baud = huart->Init.BaudRate;
+    return HAL_OK;
+}
+
+/**
+ * @brief 송수신 중단. 진행 중인 송신은 완료 인터럽트 없이 취소. 상대 장치가 보내는 중인 데이터는
+ *        다시 수신을 시작하면 받음.
+ */
+HAL_StatusTypeDef HAL_UART_Abort(UART_HandleTypeDef *huart)
+{
+    boardUart_TypeDef *u = uartOf(huart);
+    uint8_t uart = (uint8_t)(u - uarts);
+
+    for (uint32_t i = 0; i < BOARD_EVENT_MAX; i++)
+    {
+        if (events[i].used && (events[i].uart == uart) && (events[i].type == BOARD_EVENT_TX))
+        {
+            events[i].used = false;
+        }
+    }
+    u->txBusy = false;
+    u->txLineFree = simShared->now;
+    u->rxActive = false;
+    huart->gState = HAL_UART_STATE_READY;
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+/* Private -----------------------------------------------------------------*/
+
+/**
+ * @brief 지정 주소에 메모리 매핑. 주소가 이미 사용 중이면 종료.
+ *
+ * @param address: 주소
+ * @param size: 크기
+ * @param flags: MAP_SHARED 또는 MAP_PRIVATE
+ * @return void*: 매핑된 주소
+ */
+static void *mapFixed(uintptr_t address, size_t size, int flags)
+{
+    void *mapped = mmap((void *)address, size, PROT_READ | PROT_WRITE, flags | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+    if (mapped != (void *)address)
+    {
+        fprintf(stderr, "sim: cannot map 0x%08lx\n", (unsigned long)address);
+        exit(1);
+    }
+    return mapped;
+}
+
+/**
+ * @brief 가상 시각을 넘기고 전력 상태별 시간, LPTIM1 카운터, DWT 사이클 카운터 갱신.
+ *        인터럽트는 호출하지 않음.
+ *
+ * @param delta: 넘길 시간. 단위 us
+ * @param mode: 그 동안의 전력 상태
+ */
+static void passTime(uint64_t delta, simMode mode)
+{
+    uint64_t ticks;
+
+    if (!lptimRunning && ((LPTIM1->CR & LPTIM_CR_CNTSTRT) != 0U)) /* Timebase_Init() 에서 시작 */
+    {
+        lptimRunning = true;
+        lptimStart = simShared->now;
+    }
+    if (lptimRunning)
+    {
+        LPTIM1->ISR &= ~(LPTIM1->ICR & (LPTIM_ISR_CMPM | LPTIM_ISR_ARRM)); /* 플래그 지우기 반영 */
+        LPTIM1->ICR = 0U;
+    }
+
+    ticks = lptimTicks();
+    simShared->now += delta;
+    simShared->result.time[mode] += delta;
+    if (modemPower)
+    {
+        simShared->result.modemOn += delta;
+    }
+    if ((mode == SIM_MODE_RUN) && ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) != 0U))
+    {
+        DWT->CYCCNT += (uint32_t)(delta * BOARD_CPU_MHZ);
+    }
+
+    uwTick = (uint32_t)((simShared->now - cycleStart) / 1000U);
+    if (lptimRunning)
+    {
+        if (nextCompare(ticks) <= lptimTicks())
+        {
+            LPTIM1->ISR |= LPTIM_ISR_CMPM;
+        }
+        if ((ticks >> 16) != (lptimTicks() >> 16))
+        {
+            LPTIM1->ISR |= LPTIM_ISR_ARRM;
+        }
+        LPTIM1->CNT = (uint32_t)(lptimTicks() & 0xFFFFU);
+    }
+
+    if ((simShared->now - cycleStart) > ((uint64_t)SIM_CYCLE_LIMIT * 1000U))
+    {
+        Board_End(SIM_END_HANG);
+    }
+}
+
+/**
+ * @brief CPU 가 동작하는 시간. 인터럽트 허용 상태면 그 사이 인터럽트 처리.
+ *
+ * @param delta: 단위 us
+ */
+static void runFor(uint64_t delta)
+{
+    uint64_t target = simShared->now + delta;
+    uint64_t when;
+    int index;
+
+    while ((Host_Primask == 0U) && ((index = nextEvent(&when)) != -2) && (when <= target))
+    {
+        if (when > simShared->now)
+        {
+            passTime(when - simShared->now, SIM_MODE_RUN);
+        }
+        deliver(index);
+    }
+    if (target > simShared->now)
+    {
+        passTime(target - simShared->now, SIM_MODE_RUN);
+    }
+}
+
+/**
+ * @brief 가장 가까운 인터럽트까지 대기 후 처리. 인터럽트 금지 상태에서도 깨어남 (WFI 동작).
+ *        깨어난 후 인터럽트와 사용자 Loop 처리 시간을 CPU 동작으로 기록.
+ *
+ * @param mode: SIM_MODE_SLEEP 또는 SIM_MODE_STOP
+ */
+static void waitForInterrupt(simMode mode)
+{
+    uint64_t when;
+    int index = nextEvent(&when);
+
+    if (index == -2)
+    {
+        Board_End(SIM_END_NO_WAKEUP);
+    }
+    if (when > simShared->now)
+    {
+        passTime(when - simShared->now, mode);
+    }
+    deliver(index);
+    passTime(simBoard.wakeCost, SIM_MODE_RUN);
+}
+
+/**
+ * @brief 가장 가까운 인터럽트
+ *
+ * @param when: 발생 시각
+ * @return int: events 번호. -1 이면 LPTIM1, -2 이면 없음
+ */
+static int nextEvent(uint64_t *when)
+{
+    int index = -2;
+
+    *when = UINT64_MAX;
+    for (uint32_t i = 0; i < BOARD_EVENT_MAX; i++)
+    {
+        if (events[i].used && ((events[i].time < *when) || ((events[i].time == *when) && (events[i].order < events[index].order))))
+        {
+            *when = events[i].time;
+            index = (int)i;
+        }
+    }
+
+    if (lptimRunning && ((LPTIM1->CR & LPTIM_CR_ENABLE) != 0U))
+    {
+        uint64_t ticks = lptimTicks();
+        uint64_t tick = UINT64_MAX;
+
+        if (lptimPending() != 0U) /* 인터럽트 금지 중 발생 */
+        {
+            tick = ticks;
+        }
+        else
+        {
+            if ((LPTIM1->IER & LPTIM_IER_CMPMIE) != 0U)
+            {
+                tick = nextCompare(ticks);
+            }
+            if (((LPTIM1->IER & LPTIM_IER_ARRMIE) != 0U) && ((((ticks >> 16) + 1U) << 16) < tick))
+            {
+                tick = ((ticks >> 16) + 1U) << 16; /* 카운터가 0 으로 돌아가는 시점 */
+            }
+        }
+        if (tick != UINT64_MAX)
+        {
+            uint64_t time = lptimStart + (((tick * 1000000U) + 1023U) / 1024U);
+
+            if (time < simShared->now)
+            {
+                time = simShared->now;
+            }
+            if (time < *when)
+            {
+                *when = time;
+                index = -1;
+            }
+        }
+    }
+    return index;
+}
+
+/**
+ * @brief 인터럽트 처리
+ *
+ * @param index: nextEvent() 결과
+ */
+static void deliver(int index)
+{
+    boardEvent_TypeDef event;
+    boardUart_TypeDef *u;
+
+    if (index == -1)
+    {
+        uint32_t flags = lptimPending();
+
+        LPTIM1_IRQHandler();
+        LPTIM1->ISR &= ~flags; /* LPTIM1->ICR 쓰기 */
+        LPTIM1->ICR = 0U;
+        return;
+    }
+
+    event = events[index];
+    events[index].used = false; /* 처리 중 새 인터럽트 등록 가능 */
+    u = &uarts[event.uart];
+    switch (event.type)
+    {
+    case BOARD_EVENT_RX:
+        deliverRx(&event);
+        free(event.copy);
+        break;
+    case BOARD_EVENT_IDLE:
+        if (!isLineBusy(event.uart) && u->rxActive && ((u->huart->Instance->CR1 & USART_CR1_IDLEIE) != 0U))
+        {
+            Uart_RxIdleCallback(u->huart);
+        }
+        break;
+    case BOARD_EVENT_TX:
+        u->txBusy = false;
+        u->huart->gState = HAL_UART_STATE_READY;
+        if (event.uart == 0U)
+        {
+            ModemSim_Receive(event.data, event.length, event.baud);
+        }
+        else
+        {
+            LogPrint_Feed(event.data, event.length);
+        }
+        HAL_UART_TxCpltCallback(u->huart);
+        break;
+    case BOARD_EVENT_ADC:
+        adcData[0] = BOARD_ADC_BATTERY;
+        adcData[1] = (uint16_t)(simBoard.adcDevice - simBoard.adcNoise + (Board_Random() % ((2U * simBoard.adcNoise) + 1U)));
+        adcData[2] = (uint16_t)(simBoard.adcVref - 1U + (Board_Random() % 3U));
+        HAL_ADC_ConvCpltCallback(&hadc1);
+        break;
+    }
+}
+
+/**
+ * @brief 수신 묶음을 DMA 버퍼에 쓰고 절반, 끝 도달 인터럽트. 라인이 비면 IDLE 인터럽트 예약.
+ *        통신 속도가 다르면 깨진 바이트로 쓰고 프레이밍 에러 인터럽트.
+ *
+ * @param event: 수신 완료
+ */
+static void deliverRx(boardEvent_TypeDef *event)
+{
+    boardUart_TypeDef *u = &uarts[event->uart];
+    bool garbled = (event->baud != u->huart->Init.BaudRate);
+    bool half = false;
+    bool full = false;
+
+    if (!u->rxActive)
+    {
+        return;
+    }
+
+    for (uint16_t i = 0; i < event->length; i++)
+    {
+        u->rxData[u->rxPos] = garbled ? (uint8_t)(0x80U | Board_Random()) : event->copy[i];
+        u->rxPos++;
+        if (u->rxPos == (u->rxSize / 2U))
+        {
+            half = true;
+        }
+        if (u->rxPos == u->rxSize)
+        {
+            u->rxPos = 0U;
+            full = true;
+        }
+    }
+    u->huart->hdmarx->Instance->CNDTR = (uint32_t)(u->rxSize - u->rxPos);
+
+    if (garbled)
+    {
+        u->huart->Instance->ISR |= USART_ISR_FE;
+        Uart_RxErrorCallback(u->huart);
+        u->huart->Instance->ISR &= ~USART_ISR_FE;
+    }
+    if (half)
+    {
+        HAL_UART_RxHalfCpltCallback(u->huart);
+    }
+    if (full)
+    {
+        HAL_UART_RxCpltCallback(u->huart);
+    }
+    (void)addEvent(BOARD_EVENT_IDLE, event->uart, simShared->now + byteTime(1U, u->huart->Init.BaudRate));
+}
+
+/**
+ * @brief 카운터 시작 후 LPTIM1 카운트 (1024Hz)
+ *
+ * @return uint64_t: 카운트
+ */
+static uint64_t lptimTicks(void)
+{
+    return lptimRunning ? (((simShared->now - lptimStart) * 1024U) / 1000000U) : 0U;
+}
+
+/**
+ * @brief 다음 비교 일치 카운트
+ *
+ * @param ticks: 현재 카운트
+ * @return uint64_t: ticks 보다 큰 카운트 중 하위 16비트가 CMP 와 같은 첫 카운트
+ */
+static uint64_t nextCompare(uint64_t ticks)
+{
+    uint64_t compare = ticks + (((LPTIM1->CMP & 0xFFFFU) - (ticks & 0xFFFFU)) & 0xFFFFU);
+
+    return (compare == ticks) ? (compare + 0x10000U) : compare;
+}
+
+/**
+ * @brief 처리하지 않은 LPTIM1 인터럽트
+ *
+ * @return uint32_t: 허용된 ISR 플래그
+ */
+static uint32_t lptimPending(void)
+{
+    uint32_t flags = 0U;
+
+    if (((LPTIM1->ISR & LPTIM_ISR_CMPM) != 0U) && ((LPTIM1->IER & LPTIM_IER_CMPMIE) != 0U))
+    {
+        flags |= LPTIM_ISR_CMPM;
+    }
+    if (((LPTIM1->ISR & LPTIM_ISR_ARRM) != 0U) && ((LPTIM1->IER & LPTIM_IER_ARRMIE) != 0U))
+    {
+        flags |= LPTIM_ISR_ARRM;
+    }
+    return flags;
+}
+
+/**
+ * @brief 인터럽트 예약
+ *
+ * @param type: 종류
+ * @param uart: UART 번호
+ * @param time: 발생 시각
+ * @return boardEvent_TypeDef*: 예약된 항목
+ */
+static boardEvent_TypeDef *addEvent(boardEventType type, uint8_t uart, uint64_t time)
+{
+    for (uint32_t i = 0; i < BOARD_EVENT_MAX; i++)
+    {
+        if (!events[i].used)
+        {
+            memset(&events[i], 0, sizeof(events[i]));
+            events[i].used = true;
+            events[i].type = type;
+            events[i].uart = uart;
+            events[i].time = time;
+            events[i].order = eventOrder++;
+            return &events[i];
+        }
+    }
+    fprintf(stderr, "sim: too many pending interrupts\n");
+    exit(1);
+}
+
+/**
+ * @brief 전송 시간. 시작, 정지 비트 포함 10비트
+ *
+ * @param length: 바이트 수
+ * @param baud: 통신 속도
+ * @return uint64_t: 단위 us
+ */
+static uint64_t byteTime(uint32_t length, uint32_t baud)
+{
+    return (((uint64_t)length * 10U * 1000000U) + baud - 1U) / baud;
+}
+
+/**
+ * @brief 상대 장치가 송신 중인지 확인
+ *
+ * @param uart: UART 번호
+ * @return true: 지금 전송 중인 수신 묶음 있음
+ */
+static bool isLineBusy(uint8_t uart)
+{
+    for (uint32_t i = 0; i < BOARD_EVENT_MAX; i++)
+    {
+        if (events[i].used && (events[i].uart == uart) && (events[i].type == BOARD_EVENT_RX) && (events[i].start <= simShared->now))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief UART 핸들의 시뮬레이션 상태
+ */
+static boardUart_TypeDef *uartOf(UART_HandleTypeDef *huart)
+{
+    return (huart->Instance == USART1) ? &uarts[0] : &uarts[1];
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,165 @@
+/**
+  ******************************************************************************
+  * @file    logprint.c
+  * @author  정두원
+  * @date    2020-12-28
+  * @brief   바이너리 로그 출력
+  * @details USART2 로 송신한 로그 레코드를 .logfmt 섹션의 형식 문자열로 변환하여 출력 (-v).
+  *          Tools/logdecode.py 와 같은 형식. 호스트 빌드에서는 형식 ID 가 .logfmt 섹션 주소의 하위 16비트.
+  */
+
+#include <stdio.h>
+#include <string.h>
+#include "sim.h"
+#include "log.h"
+
+/** @defgroup LOGPRINT 바이너리 로그 출력
+  * @brief USART2 송신 데이터 변환
+  * @{
+  */
+
+#define LOGPRINT_HEADER 8U /*!< 0xA5 | 레벨<<4 + 인자 갯수 | 형식 ID(2) | 시각 ms(4) */
+
+extern const char __logfmt_start[]; /*!< Host/Sim/sim.ld */
+extern const char __logfmt_end[];
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t record[LOGPRINT_HEADER + (4U * LOG_ARGS_MAX)];
+static uint8_t recordLength;
+
+/* Private functions ---------------------------------------------------------*/
+static void printRecord(void);
+static void render(char *out, size_t size, const char *format, const uint32_t *args, uint8_t count);
+
+/**
+ * @brief USART2 송신 데이터. 레코드 단위로 모아 출력.
+ *
+ * @param data: 송신 데이터
+ * @param length: 길이
+ */
+void LogPrint_Feed(const uint8_t *data, uint16_t length)
+{
+    for (uint16_t i = 0; i < length; i++)
+    {
+        if ((recordLength == 0U) && (data[i] != LOG_SYNC)) /* 레코드 시작 찾기 */
+        {
+            continue;
+        }
+        record[recordLength++] = data[i];
+        if ((recordLength >= 2U) && ((record[1] & 0x0FU) > LOG_ARGS_MAX))
+        {
+            recordLength = 0U;
+        }
+        else if ((recordLength >= LOGPRINT_HEADER) && (recordLength == (LOGPRINT_HEADER + (4U * (record[1] & 0x0FU)))))
+        {
+            printRecord();
+            recordLength = 0U;
+        }
+    }
+}
+
+/**
+ * @brief 레코드 하나 출력
+ *
+ */
+static void printRecord(void)
+{
+    static const char *const levels[] = {"ERROR", "WARN", "INFO", "DEBUG"};
+    uint16_t id = (uint16_t)(record[2] | (record[3] << 8));
+    uint32_t tick;
+    uint32_t args[LOG_ARGS_MAX];
+    uint8_t count = record[1] & 0x0FU;
+    uint16_t offset = (uint16_t)(id - (uint16_t)(uintptr_t)__logfmt_start);
+    char text[256];
+
+    memcpy(&tick, &record[4], sizeof(tick));
+    memcpy(args, &record[LOGPRINT_HEADER], 4U * count);
+    if (!simShared->verbose)
+    {
+        return;
+    }
+    if (offset >= (uint16_t)(__logfmt_end - __logfmt_start))
+    {
+        (void)snprintf(text, sizeof(text), "unknown format 0x%04x", id);
+    }
+    else
+    {
+        render(text, sizeof(text), &__logfmt_start[offset], args, count);
+    }
+    printf("%10.3f  %-5s %s\n", (double)Board_Now() / 1e6, levels[(record[1] >> 4) & 3U], text);
+}
+
+/**
+ * @brief printf 형식을 32비트 인자로 변환. 길이 수식자는 무시하고 %f 계열은 float 비트로 해석.
+ *
+ * @param out: 출력 버퍼
+ * @param size: 출력 버퍼 크기
+ * @param format: 형식 문자열
+ * @param args: 인자
+ * @param count: 인자 갯수
+ */
+static void render(char *out, size_t size, const char *format, const uint32_t *args, uint8_t count)
+{
+    size_t used = 0U;
+    uint8_t next = 0U;
+
+    while ((*format != '\0') && (used + 1U < size))
+    {
+        char spec[16] = "%";
+        size_t specLength = 1U;
+        uint32_t value;
+        float real;
+
+        if (*format != '%')
+        {
+            out[used++] = *format++;
+            continue;
+        }
+        format++;
+        while ((strchr("-+ #0123456789.", *format) != NULL) && (*format != '\0') && (specLength < (sizeof(spec) - 3U)))
+        {
+            spec[specLength++] = *format++;
+        }
+        while ((*format == 'l') || (*format == 'h') || (*format == 'z'))
+        {
+            format++;
+        }
+        if (*format == '\0')
+        {
+            break;
+        }
+        spec[specLength++] = (*format == 'p') ? 'x' : *format;
+        spec[specLength] = '\0';
+
+        value = (next < count) ? args[next] : 0U;
+        switch (*format++)
+        {
+        case '%':
+            out[used++] = '%';
+            continue;
+        case 'd':
+        case 'i':
+        case 'c':
+            (void)snprintf(&out[used], size - used, spec, (int)value);
+            break;
+        case 'f':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+            memcpy(&real, &value, sizeof(real));
+            (void)snprintf(&out[used], size - used, spec, (double)real);
+            break;
+        default:
+            (void)snprintf(&out[used], size - used, spec, (unsigned int)value);
+            break;
+        }
+        next++;
+        used += strlen(&out[used]);
+    }
+    out[(used < size) ? used : (size - 1U)] = '\0';
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,506 @@
+/**
+  ******************************************************************************
+  * @file    modemsim.c
+  * @author  정두원
+  * @date    2020-12-28
+  * @brief   LTE 모뎀 시나리오
+  * @details USART1 로 받은 AT 명령에 시나리오 파일의 규칙대로 지연 후 응답. 규칙은 위에서부터 처음
+  *          일치하는 것을 사용하므로 지연, 에러 주입 규칙을 정상 응답 규칙보다 위에 둠.
+  *
+  *          # 주석
+  *          boot <ms>                 전원을 켠 후 명령을 받기 시작할 때까지 시간
+  *          baud <bps>                처음 통신 속도
+  *          ipr keep|reset            AT+IPR 로 바꾼 속도를 전원을 꺼도 유지 | 켤 때마다 처음 속도
+  *          echo on|off               전원을 켤 때 ECHO 상태
+  *          adc <device> <noise>      외부 디바이스 ADC 코드와 잡음 폭
+  *          vref <code>               VREFINT ADC 코드
+  *          din <0~15>                DIN3~0 입력
+  *          cost boot|wake <us>       깨어난 후 userStart() 까지, 인터럽트 한 번 처리 CPU 시간
+  *          debug <주기> <ms> <입력>   그 주기에 부팅 시 사용자 버튼을 눌렀다 떼고(POWEROFF 로 깨어 있음)
+  *                                    깨어난 후 <ms> 에 DEBUG 포트로 <입력> 한 줄 수신 (예: CFG=300,...)
+  *          [cycle=N|N-M] [p=0.x] [nth=K] <명령 접두어> <지연 ms|최소~최대> <응답>
+  *
+  *          응답은 '|' 로 줄을 나누고, 줄 앞의 +<ms> 는 앞 줄 이후 추가 지연(URC), none 은 응답 없음.
+  *          cycle 은 깨어남 주기, p 는 확률, nth 는 이번 주기에 조건이 맞은 K 번째 명령에만 적용.
+  *          조건이 있는 규칙이 적용되면 주입한 장애로 집계.
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+/** @defgroup MODEMSIM LTE 모뎀 시나리오
+  * @brief AT 명령 응답, 지연, 에러 주입
+  * @{
+  */
+
+#define MODEMSIM_RULE_MAX 64U     /*!< 규칙 최대 갯수 */
+#define MODEMSIM_PREFIX_MAX 48U   /*!< 명령 접두어 최대 길이 */
+#define MODEMSIM_REPLY_MAX 256U   /*!< 응답 최대 길이 */
+#define MODEMSIM_COMMAND_MAX 2048U /*!< 명령 한 줄 최대 길이 */
+#define MODEMSIM_LINE_MAX 512U    /*!< 시나리오 파일 한 줄 최대 길이 */
+
+typedef struct
+{
+    uint32_t cycleFirst; /*!< 적용 주기. 0 이면 모든 주기 */
+    uint32_t cycleLast;
+    double probability;  /*!< 적용 확률 */
+    uint16_t nth;        /*!< 조건이 맞은 몇 번째 명령에 적용. 0 이면 모두 */
+    uint16_t seen;       /*!< 이번 주기에 조건이 맞은 횟수 */
+    bool conditional;    /*!< 조건이 있는 규칙 (장애 주입) */
+    char prefix[MODEMSIM_PREFIX_MAX];
+    uint32_t delayMin;   /*!< 응답 지연. 단위 ms */
+    uint32_t delayMax;
+    char reply[MODEMSIM_REPLY_MAX];
+} modemRule_TypeDef; /*!< 응답 규칙 */
+
+typedef struct
+{
+    uint32_t boot;    /*!< 부팅 시간. 단위 ms */
+    uint32_t baud;    /*!< 처음 통신 속도 */
+    bool iprKeep;     /*!< 전원을 꺼도 AT+IPR 속도 유지 */
+    bool echo;        /*!< 전원을 켤 때 ECHO */
+    modemRule_TypeDef rules[MODEMSIM_RULE_MAX];
+    uint8_t ruleCount;
+} modemScript_TypeDef; /*!< 시나리오 */
+
+/* Private variables ---------------------------------------------------------*/
+static modemScript_TypeDef script = {.boot = 3000U, .baud = 115200U, .iprKeep = true, .echo = true};
+static bool powered;       /*!< LTE_WAKEUP */
+static uint64_t readyTime; /*!< 명령을 받기 시작하는 시각. 단위 us */
+static bool echo;          /*!< 현재 ECHO 상태 */
+static char command[MODEMSIM_COMMAND_MAX];
+static uint16_t commandLength;
+static bool commandGarbled; /*!< 통신 속도가 달라 깨진 명령 */
+
+/* Private functions ---------------------------------------------------------*/
+static bool parseRule(char *line, modemRule_TypeDef *rule);
+static void handleCommand(void);
+static const modemRule_TypeDef *findRule(void);
+static void reply(const modemRule_TypeDef *rule);
+static void send(const char *text, uint64_t at);
+static uint16_t httpStatus(const char *text);
+
+/**
+ * @brief 시나리오 파일 읽기
+ *
+ * @param path: 파일 경로
+ * @return true: 성공
+ */
+bool ModemSim_Load(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    char line[MODEMSIM_LINE_MAX];
+    uint32_t number = 0U;
+    bool ok = true;
+
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    while (ok && (fgets(line, sizeof(line), file) != NULL))
+    {
+        char word[16];
+        char value[16];
+        unsigned long a;
+        unsigned long b;
+        int offset = 0;
+
+        number++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if ((line[strspn(line, " \t")] == '\0') || (line[strspn(line, " \t")] == '#'))
+        {
+            continue;
+        }
+
+        if (sscanf(line, "boot %lu", &a) == 1)
+        {
+            script.boot = (uint32_t)a;
+        }
+        else if (sscanf(line, "baud %lu", &a) == 1)
+        {
+            script.baud = (uint32_t)a;
+        }
+        else if (sscanf(line, "ipr %15s", value) == 1)
+        {
+            script.iprKeep = (strcmp(value, "keep") == 0);
+        }
+        else if (sscanf(line, "echo %15s", value) == 1)
+        {
+            script.echo = (strcmp(value, "on") == 0);
+        }
+        else if (sscanf(line, "adc %lu %lu", &a, &b) == 2)
+        {
+            simBoard.adcDevice = (uint16_t)a;
+            simBoard.adcNoise = (uint16_t)b;
+        }
+        else if (sscanf(line, "vref %lu", &a) == 1)
+        {
+            simBoard.adcVref = (uint16_t)a;
+        }
+        else if (sscanf(line, "din %lu", &a) == 1)
+        {
+            simBoard.din = (uint8_t)(a & 0x0FU);
+        }
+        else if ((sscanf(line, "debug %lu %lu %n", &a, &b, &offset) == 2) && (simBoard.debugCount < SIM_DEBUG_MAX))
+        {
+            simDebug_TypeDef *debug = &simBoard.debug[simBoard.debugCount++];
+
+            debug->cycle = (uint32_t)a;
+            debug->delay = (uint32_t)b;
+            (void)snprintf(debug->text, sizeof(debug->text), "%s", &line[offset]);
+        }
+        else if (sscanf(line, "cost %15s %lu", word, &a) == 2)
+        {
+            if (strcmp(word, "boot") == 0)
+            {
+                simBoard.bootCost = (uint32_t)a;
+            }
+            else
+            {
+                simBoard.wakeCost = (uint32_t)a;
+            }
+        }
+        else if (script.ruleCount >= MODEMSIM_RULE_MAX)
+        {
+            fprintf(stderr, "%s:%u: too many rules\n", path, number);
+            ok = false;
+        }
+        else if (parseRule(line, &script.rules[script.ruleCount]))
+        {
+            script.ruleCount++;
+        }
+        else
+        {
+            fprintf(stderr, "%s:%u: cannot parse '%s'\n", path, number, line);
+            ok = false;
+        }
+    }
+    fclose(file);
+
+    simShared->modemBaud = script.baud;
+    return ok;
+}
+
+/**
+ * @brief 주기 시작. 전원 꺼짐.
+ *
+ */
+void ModemSim_Reset(void)
+{
+    powered = false;
+    commandLength = 0U;
+    commandGarbled = false;
+}
+
+/**
+ * @brief LTE_WAKEUP 변경. 켜면 boot 시간 후 명령을 받기 시작.
+ *
+ * @param on: true: 켬
+ */
+void ModemSim_Power(bool on)
+{
+    powered = on;
+    if (on)
+    {
+        readyTime = Board_Now() + ((uint64_t)script.boot * 1000U);
+        echo = script.echo;
+        commandLength = 0U;
+        commandGarbled = false;
+        if (!script.iprKeep)
+        {
+            simShared->modemBaud = script.baud;
+        }
+    }
+}
+
+/**
+ * @brief USART1 송신 데이터 수신. CR 까지 모아 명령 처리.
+ *
+ * @param data: 송신 데이터
+ * @param length: 길이
+ * @param baud: MCU 통신 속도
+ */
+void ModemSim_Receive(const uint8_t *data, uint16_t length, uint32_t baud)
+{
+    if (!powered || (Board_Now() < readyTime)) /* 부팅 중 받은 데이터는 버림 */
+    {
+        return;
+    }
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        if (data[i] == '\n')
+        {
+            continue;
+        }
+        if (data[i] == '\r')
+        {
+            command[commandLength] = '\0';
+            if (!commandGarbled && (commandLength > 0U))
+            {
+                handleCommand();
+            }
+            commandLength = 0U;
+            commandGarbled = false;
+            continue;
+        }
+        if (commandLength < (MODEMSIM_COMMAND_MAX - 1U))
+        {
+            command[commandLength++] = (char)data[i];
+        }
+        if (baud != simShared->modemBaud)
+        {
+            commandGarbled = true;
+        }
+    }
+}
+
+/**
+ * @brief 규칙 한 줄 분석
+ *
+ * @param line: 시나리오 파일 한 줄
+ * @param rule: 분석 결과
+ * @return true: 성공
+ */
+static bool parseRule(char *line, modemRule_TypeDef *rule)
+{
+    char *save = NULL;
+    char *token = strtok_r(line, " \t", &save);
+    char *rest;
+    unsigned long a;
+    unsigned long b;
+
+    memset(rule, 0, sizeof(modemRule_TypeDef));
+    rule->probability = 1.0;
+
+    while ((token != NULL) && (strchr(token, '=') != NULL) && (strncmp(token, "AT", 2U) != 0))
+    {
+        if (sscanf(token, "cycle=%lu-%lu", &a, &b) == 2)
+        {
+            rule->cycleFirst = (uint32_t)a;
+            rule->cycleLast = (uint32_t)b;
+        }
+        else if (sscanf(token, "cycle=%lu", &a) == 1)
+        {
+            rule->cycleFirst = (uint32_t)a;
+            rule->cycleLast = (uint32_t)a;
+        }
+        else if (sscanf(token, "p=%lf", &rule->probability) != 1)
+        {
+            if (sscanf(token, "nth=%lu", &a) != 1)
+            {
+                return false;
+            }
+            rule->nth = (uint16_t)a;
+        }
+        rule->conditional = true;
+        token = strtok_r(NULL, " \t", &save);
+    }
+
+    if ((token == NULL) || (strlen(token) >= MODEMSIM_PREFIX_MAX))
+    {
+        return false;
+    }
+    strcpy(rule->prefix, token);
+
+    token = strtok_r(NULL, " \t", &save);
+    if (token == NULL)
+    {
+        return false;
+    }
+    if (sscanf(token, "%lu~%lu", &a, &b) == 2)
+    {
+        rule->delayMin = (uint32_t)a;
+        rule->delayMax = (uint32_t)b;
+    }
+    else if (sscanf(token, "%lu", &a) == 1)
+    {
+        rule->delayMin = (uint32_t)a;
+        rule->delayMax = (uint32_t)a;
+    }
+    else
+    {
+        return false;
+    }
+
+    rest = save + strspn(save, " \t");
+    if ((*rest == '\0') || (strlen(rest) >= MODEMSIM_REPLY_MAX) || (rule->delayMax < rule->delayMin))
+    {
+        return false;
+    }
+    strcpy(rule->reply, rest);
+    return true;
+}
+
+/**
+ * @brief 받은 명령 처리. ECHO, 규칙의 응답, 응답 후 AT+IPR 속도 변경, ATE0/ATE1 반영.
+ *
+ */
+static void handleCommand(void)
+{
+    const modemRule_TypeDef *rule;
+    uint32_t rate;
+
+    simShared->result.commands++;
+    if (echo)
+    {
+        char text[MODEMSIM_COMMAND_MAX + 2U];
+
+        (void)snprintf(text, sizeof(text), "%s\r", command);
+        Board_Receive(0U, (const uint8_t *)text, (uint16_t)strlen(text), simShared->modemBaud, Board_Now());
+    }
+    if (simShared->verbose)
+    {
+        printf("%10.3f  modem < %.60s\n", (double)Board_Now() / 1e6, command);
+    }
+
+    rule = findRule();
+    if (rule == NULL)
+    {
+        send("ERROR", Board_Now());
+        return;
+    }
+    reply(rule);
+
+    if (strstr(rule->reply, "OK") != NULL)
+    {
+        if (sscanf(command, "AT+IPR=%u", &rate) == 1) /* OK 응답 후 속도 변경 */
+        {
+            simShared->modemBaud = rate;
+        }
+        else if (strcmp(command, "ATE0") == 0)
+        {
+            echo = false;
+        }
+        else if (strcmp(command, "ATE1") == 0)
+        {
+            echo = true;
+        }
+    }
+}
+
+/**
+ * @brief 명령에 적용할 규칙
+ *
+ * @return const modemRule_TypeDef*: 없으면 NULL
+ */
+static const modemRule_TypeDef *findRule(void)
+{
+    for (uint8_t i = 0; i < script.ruleCount; i++)
+    {
+        modemRule_TypeDef *rule = &script.rules[i];
+
+        if (strncmp(command, rule->prefix, strlen(rule->prefix)) != 0)
+        {
+            continue;
+        }
+        if ((rule->cycleFirst != 0U) && ((simShared->cycle < rule->cycleFirst) || (simShared->cycle > rule->cycleLast)))
+        {
+            continue;
+        }
+        if ((rule->nth != 0U) && (++rule->seen != rule->nth))
+        {
+            continue;
+        }
+        if ((rule->probability < 1.0) && (((double)Board_Random() / 4294967296.0) >= rule->probability))
+        {
+            continue;
+        }
+        if (rule->conditional)
+        {
+            simShared->result.faults++;
+        }
+        return rule;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 규칙의 응답 송신
+ *
+ * @param rule: 적용할 규칙
+ */
+static void reply(const modemRule_TypeDef *rule)
+{
+    char text[MODEMSIM_REPLY_MAX];
+    char *save = NULL;
+    uint64_t at = Board_Now() + ((uint64_t)rule->delayMin * 1000U);
+
+    if (rule->delayMax > rule->delayMin)
+    {
+        at += (uint64_t)(Board_Random() % (rule->delayMax - rule->delayMin + 1U)) * 1000U;
+    }
+
+    strcpy(text, rule->reply);
+    for (char *line = strtok_r(text, "|", &save); line != NULL; line = strtok_r(NULL, "|", &save))
+    {
+        unsigned long extra;
+        int used = 0;
+
+        if (sscanf(line, "+%lu %n", &extra, &used) == 1)
+        {
+            at += (uint64_t)extra * 1000U;
+            line += used;
+        }
+        if (strcmp(line, "none") != 0)
+        {
+            send(line, at);
+        }
+        if ((strncmp(command, "AT*WHTTP=3", 10U) == 0) && (httpStatus(line) >= 200U) && (httpStatus(line) <= 299U))
+        {
+            simShared->result.posts++;
+        }
+    }
+}
+
+/**
+ * @brief 응답 한 줄 송신. 앞뒤에 CR LF.
+ *
+ * @param text: 응답
+ * @param at: 송신 시각. 단위 us
+ */
+static void send(const char *text, uint64_t at)
+{
+    char line[MODEMSIM_REPLY_MAX + 4U];
+
+    (void)snprintf(line, sizeof(line), "\r\n%s\r\n", text);
+    if (simShared->verbose)
+    {
+        printf("%10.3f  modem > %.60s\n", (double)at / 1e6, text);
+    }
+    Board_Receive(0U, (const uint8_t *)line, (uint16_t)strlen(line), simShared->modemBaud, at);
+}
+
+/**
+ * @brief *WHTTPR 응답의 HTTP 상태 코드
+ *
+ * @param text: 응답 한 줄
+ * @return uint16_t: 없으면 0
+ */
+static uint16_t httpStatus(const char *text)
+{
+    const char *comma;
+
+    if (strncmp(text, "*WHTTPR:", 8U) != 0)
+    {
+        return 0U;
+    }
+    for (comma = strchr(text, ','); comma != NULL; comma = strchr(comma + 1, ','))
+    {
+        unsigned int status = (unsigned int)strtoul(comma + 1, NULL, 10);
+
+        if ((status >= 100U) && (status <= 599U))
+        {
+            return (uint16_t)status;
+        }
+    }
+    return 0U;
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,174 @@
+/**
+  ******************************************************************************
+  * @file    sim.c
+  * @author  정두원
+  * @date    2020-12-28
+  * @brief   호스트 시뮬레이션 실행
+  * @details 깨어남 한 번을 자식 프로세스 하나로 실행. 스탠바이에서 깨어나면 RAM 이 초기화되는 것과 같이
+  *          주기마다 .data, .bss 가 처음 상태이고 백업 레지스터, SRAM2, 플래시는 공유 메모리로 유지.
+  *          주기마다 깨어 있던 시간(CPU 동작, Sleep, Stop 1)과 모뎀 전원 시간 출력.
+  *
+  *          사용법: sim [-n 주기] [-s 시드] [-p 전송 수] [-v] <시나리오 파일>
+  *          -p 를 주면 서버 전송(2xx 응답) 수가 다를 때 실패 (중복 전송, 전송 누락 확인)
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "sim.h"
+#include "user.h"
+
+/** @defgroup SIM 호스트 시뮬레이션
+  * @brief 깨어남 주기 반복
+  * @{
+  */
+
+#define SIM_CYCLES_DEFAULT 10U /*!< 기본 주기 수 */
+
+/* Private functions ---------------------------------------------------------*/
+static void runCycle(void);
+static void printCycle(const simCycle_TypeDef *result);
+
+static const char *const endName[] = {"standby", "hang", "no wakeup", "crash"};
+
+int main(int argc, char *argv[])
+{
+    uint32_t cycles = SIM_CYCLES_DEFAULT;
+    uint32_t seed = 1U;
+    bool verbose = false;
+    uint64_t awakeTotal = 0U;
+    uint64_t awakeMax = 0U;
+    uint32_t posts = 0U;
+    uint32_t faults = 0U;
+    long expectPosts = -1;
+    int option;
+
+    while ((option = getopt(argc, argv, "n:s:p:v")) != -1)
+    {
+        switch (option)
+        {
+        case 'n':
+            cycles = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            seed = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            expectPosts = strtol(optarg, NULL, 0);
+            break;
+        case 'v':
+            verbose = true;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n cycles] [-s seed] [-p posts] [-v] script\n", argv[0]);
+            return 2;
+        }
+    }
+    if (optind != (argc - 1))
+    {
+        fprintf(stderr, "usage: %s [-n cycles] [-s seed] [-p posts] [-v] script\n", argv[0]);
+        return 2;
+    }
+
+    Board_Map();
+    simShared = mmap(NULL, sizeof(simShared_TypeDef), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (simShared == MAP_FAILED)
+    {
+        perror("mmap");
+        return 1;
+    }
+    memset(simShared, 0, sizeof(simShared_TypeDef));
+    simShared->seed = seed;
+    simShared->verbose = verbose;
+    if (!ModemSim_Load(argv[optind]))
+    {
+        return 1;
+    }
+
+    printf("cycle    start(s)  awake(ms)    run(ms)  sleep(ms)   stop(ms)  modem(ms)   AT fault post  standby(s)\n");
+    for (simShared->cycle = 1U; simShared->cycle <= cycles; simShared->cycle++)
+    {
+        const simCycle_TypeDef *result = &simShared->result;
+        uint64_t awake;
+
+        runCycle();
+        printCycle(result);
+        if (result->end != SIM_END_STANDBY)
+        {
+            printf("cycle %u ended: %s\n", simShared->cycle, endName[result->end]);
+            return 1;
+        }
+
+        awake = result->time[SIM_MODE_RUN] + result->time[SIM_MODE_SLEEP] + result->time[SIM_MODE_STOP];
+        awakeTotal += awake;
+        awakeMax = (awake > awakeMax) ? awake : awakeMax;
+        posts += result->posts;
+        faults += result->faults;
+        simShared->now += (uint64_t)result->standby * 1000000U; /* 스탠바이 동안 */
+    }
+
+    printf("%u cycles, awake mean %.1f ms, max %.1f ms, %u posts, %u faults injected, awake %.3f%% of %.0f s\n",
+           cycles, (double)awakeTotal / cycles / 1000.0, (double)awakeMax / 1000.0, posts, faults,
+           (double)awakeTotal * 100.0 / (double)simShared->now, (double)simShared->now / 1e6);
+    if ((expectPosts >= 0) && (posts != (uint32_t)expectPosts))
+    {
+        printf("expected %ld posts\n", expectPosts);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 깨어남 한 번을 자식 프로세스로 실행하고 끝날 때까지 대기
+ *
+ */
+static void runCycle(void)
+{
+    pid_t pid;
+    int status;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        exit(1);
+    }
+    if (pid == 0)
+    {
+        Board_Reset();
+        userStart();
+        for (;;)
+        {
+            userLoop();
+        }
+    }
+
+    (void)waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+    {
+        simShared->result.end = SIM_END_CRASH;
+    }
+}
+
+/**
+ * @brief 주기 결과 한 줄 출력
+ *
+ * @param result: 주기 결과
+ */
+static void printCycle(const simCycle_TypeDef *result)
+{
+    uint64_t awake = result->time[SIM_MODE_RUN] + result->time[SIM_MODE_SLEEP] + result->time[SIM_MODE_STOP];
+
+    printf("%5u %11.3f %10.1f %10.1f %10.1f %10.1f %10.1f %4u %5u %4u %11u\n", simShared->cycle,
+           (double)result->start / 1e6, (double)awake / 1000.0, (double)result->time[SIM_MODE_RUN] / 1000.0,
+           (double)result->time[SIM_MODE_SLEEP] / 1000.0, (double)result->time[SIM_MODE_STOP] / 1000.0,
+           (double)result->modemOn / 1000.0, result->commands, result->faults, result->posts, result->standby);
+}
+
+/**
+  * @}
+  */
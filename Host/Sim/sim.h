@@ -0,0 +1,95 @@
+#ifndef SIM_H__
+#define SIM_H__ 1
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "main.h"
+
+#define SIM_SRAM2_MAX 8192U      /*!< 보관할 수 있는 .retained 섹션 크기. SRAM2 8K */
+#define SIM_UART_COUNT 2U        /*!< 0: USART1 (LTE 모뎀), 1: USART2 (DEBUG) */
+#define SIM_CYCLE_LIMIT 600000U  /*!< 한 주기에 깨어 있을 수 있는 최대 시간. 넘으면 멈춤으로 판단. 단위 ms */
+#define SIM_DEBUG_MAX 8U         /*!< DEBUG 포트 입력 최대 갯수 */
+#define SIM_DEBUG_TEXT_MAX 128U  /*!< DEBUG 포트 입력 한 줄 최대 길이 */
+
+typedef enum
+{
+    SIM_MODE_RUN = 0, /*!< CPU 동작 */
+    SIM_MODE_SLEEP,   /*!< WFI */
+    SIM_MODE_STOP,    /*!< Stop 1 */
+    SIM_MODE_COUNT
+} simMode; /*!< 전력 상태 */
+
+typedef enum
+{
+    SIM_END_STANDBY = 0, /*!< 스탠바이 진입 */
+    SIM_END_HANG,        /*!< SIM_CYCLE_LIMIT 안에 스탠바이 진입하지 않음 */
+    SIM_END_NO_WAKEUP,   /*!< 깨어날 인터럽트가 없는데 대기 */
+    SIM_END_CRASH        /*!< 프로세스 비정상 종료 */
+} simEnd; /*!< 주기 종료 원인 */
+
+typedef struct
+{
+    uint32_t cycle;                 /*!< 입력할 주기 */
+    uint32_t delay;                 /*!< 깨어난 후 입력 시각. 단위 ms */
+    char text[SIM_DEBUG_TEXT_MAX];  /*!< 입력 한 줄. CR LF 를 붙여 보냄 */
+} simDebug_TypeDef;                 /*!< DEBUG 포트 입력 */
+
+typedef struct
+{
+    uint32_t bootCost;  /*!< 스탠바이에서 깨어나 userStart() 까지 (클럭 설정 등). 단위 us */
+    uint32_t wakeCost;  /*!< 인터럽트 한 번과 사용자 Loop 한 번 처리. 단위 us */
+    uint16_t adcDevice; /*!< 외부 디바이스 ADC 코드 */
+    uint16_t adcNoise;  /*!< ADC 코드 잡음 폭 (+-) */
+    uint16_t adcVref;   /*!< VREFINT ADC 코드 */
+    uint8_t din;        /*!< [3:0] DIN3~0 입력 */
+    simDebug_TypeDef debug[SIM_DEBUG_MAX]; /*!< DEBUG 포트 입력. 입력이 있는 주기는 부팅 시 사용자 버튼을 눌렀다 뗌 */
+    uint8_t debugCount;
+} simBoard_TypeDef;     /*!< 보드 설정. 시나리오 파일에서 읽음 */
+
+typedef struct
+{
+    uint64_t start;              /*!< 깨어난 시각. 단위 us */
+    uint64_t time[SIM_MODE_COUNT]; /*!< 전력 상태별 시간. 단위 us */
+    uint64_t modemOn;            /*!< LTE_WAKEUP 을 켜 둔 시간. 단위 us */
+    uint32_t standby;            /*!< 설정된 스탠바이 시간. 단위 초 */
+    uint16_t commands;           /*!< LTE 모뎀이 받은 AT 명령 수 */
+    uint16_t posts;              /*!< 2xx 로 응답한 AT*WHTTP=3 수 */
+    uint16_t faults;             /*!< 주입한 지연, 에러 응답 수 */
+    simEnd end;                  /*!< 종료 원인 */
+} simCycle_TypeDef;              /*!< 한 주기 결과 */
+
+typedef struct
+{
+    uint64_t now;                    /*!< 가상 시각. 단위 us */
+    uint32_t cycle;                  /*!< 주기 번호. 1 부터 */
+    uint32_t seed;                   /*!< 난수 시드 */
+    bool verbose;                    /*!< 펌웨어 로그 출력 */
+    uint32_t backup[RTC_BKP_NUMBER]; /*!< RTC 백업 레지스터 */
+    uint8_t sram2[SIM_SRAM2_MAX];    /*!< 스탠바이 중 유지된 .retained 섹션 */
+    bool sram2Kept;                  /*!< sram2 유효 */
+    uint32_t modemBaud;              /*!< LTE 모뎀 통신 속도. AT+IPR 로 변경 */
+    simCycle_TypeDef result;         /*!< 이번 주기 결과 */
+} simShared_TypeDef;                 /*!< 주기(프로세스) 사이에 유지되는 상태. 공유 메모리 */
+
+extern simShared_TypeDef *simShared;
+extern simBoard_TypeDef simBoard;
+
+/* board.c ------------------------------------------------------------------*/
+void Board_Map(void);                                                   /*!< 플래시, 주변장치 주소에 메모리 매핑 */
+void Board_Reset(void);                                                 /*!< 깨어남. 주변장치 초기 상태 */
+uint64_t Board_Now(void);                                               /*!< 가상 시각. 단위 us */
+void Board_Receive(uint8_t uart, const uint8_t *data, uint16_t length, uint32_t baud, uint64_t at); /*!< 상대 장치 송신 */
+uint32_t Board_Random(void);                                            /*!< 난수 */
+void Board_End(simEnd end);                                             /*!< 주기 종료. 반환하지 않음 */
+
+/* modemsim.c ---------------------------------------------------------------*/
+bool ModemSim_Load(const char *path);                                   /*!< 시나리오 파일 읽기 */
+void ModemSim_Reset(void);                                              /*!< 주기 시작. 전원 꺼짐 */
+void ModemSim_Power(bool on);                                           /*!< LTE_WAKEUP 변경 */
+void ModemSim_Receive(const uint8_t *data, uint16_t length, uint32_t baud); /*!< USART1 송신 데이터 수신 */
+
+/* logprint.c ---------------------------------------------------------------*/
+void LogPrint_Feed(const uint8_t *data, uint16_t length);               /*!< USART2 송신 데이터(바이너리 로그) 출력 */
+
+#endif /* SIM_H__ */
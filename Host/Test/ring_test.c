@@ -0,0 +1,637 @@
+/**
+  ******************************************************************************
+  * @file    ring_test.c
+  * @author  정두원
+  * @date    2020-12-29
+  * @brief   링 버퍼 선점 시험
+  * @details 사용자 Loop 쪽 동작(main) 실행 중 모든 명령어 위치에서 인터럽트 쪽 동작(isr)을 한 번 끼워 넣어
+  *          순서, 갯수, 가득 참/비어 있음 판단을 확인. x86-64 의 단일 단계 실행(EFLAGS.TF)으로 명령어마다
+  *          SIGTRAP 을 받아 k 번째 명령어 뒤에서 isr 실행 (0 ~ 전체 명령어 수).
+  *          생산자(Put, WriteSpan/Commit, DMA 쓰기 + SyncDMA)를 소비자(Get, ReadSpan/Consume) 안에,
+  *          반대로 소비자를 생산자 안에 끼워 넣고, in/out 이 uint16 최대값을 넘어가는 위치에서 시작.
+  *          getLineFromBuffer() 는 링 버퍼 끝에서 나뉜 줄과 DMA 수신을 끼워 넣은 줄 분리,
+  *          읽기 전에 DMA 가 덮어쓴 데이터를 버리는지 확인.
+  * @note   x86 은 메모리 순서가 강하므로 __DMB() 위치가 아니라 인덱스 갱신 순서와 판단 논리를 시험.
+  */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ring.h"
+#include "uart.h"
+
+#if !defined(__x86_64__)
+#error "ring_test: x86-64 single-step (EFLAGS.TF) only"
+#endif
+
+/** @defgroup RING_TEST 링 버퍼 선점 시험
+  * @{
+  */
+
+#define TEST_RING_SIZE 8U     /*!< 시험 링 버퍼 크기. 작게 하여 버퍼 끝을 자주 넘어감 */
+#define TEST_EMPTY_BYTE 0xEEU /*!< 쓰지 않은 칸 */
+
+#define CHECK(cond)                                                                                   \
+    do                                                                                                \
+    {                                                                                                 \
+        if (!(cond))                                                                                  \
+        {                                                                                             \
+            failure(__LINE__, #cond);                                                                 \
+        }                                                                                             \
+    } while (0)
+
+typedef void (*testStep)(void);
+
+typedef struct
+{
+    const char *name;
+    testStep main; /*!< 사용자 Loop 쪽 동작 */
+    testStep isr;  /*!< 끼워 넣을 인터럽트 쪽 동작 */
+} testCase_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static ring_TypeDef ring;
+static uint8_t ringBuff[TEST_RING_SIZE];
+static uint32_t nextRead;   /*!< 소비자가 다음에 읽을 순번 */
+static uint32_t nextWrite;  /*!< 생산자가 다음에 쓸 순번 */
+static uint16_t preCount;   /*!< 실행 전 저장된 갯수 */
+static uint16_t amount;     /*!< Span, DMA 동작의 요청 길이 */
+static bool mainResult;     /*!< main 쪽 Get, Put 결과 */
+static bool isrResult;      /*!< isr 쪽 Get, Put 결과 */
+static const char *context; /*!< 실패 출력용 */
+static uint32_t failures;
+static uint64_t runs;
+
+static volatile uint32_t stepCount;  /*!< 단일 단계 실행한 명령어 수 */
+static volatile uint32_t injectAt;   /*!< 이 명령어 뒤에서 isr 실행 */
+static volatile bool injected;
+static testStep injectStep;
+
+/* Private functions ---------------------------------------------------------*/
+static void failure(int line, const char *text);
+static uint8_t seqByte(uint32_t seq);
+static void setup(uint16_t base, uint16_t fill);
+static uint32_t runPreempted(testStep main, testStep isr, uint32_t at);
+static void onTrap(int sig, siginfo_t *info, void *context);
+static void checkRing(void);
+static void runCase(const testCase_TypeDef *test);
+static void testLines(void);
+static void testLinesPreempted(void);
+
+/* 소비자 --------------------------------------------------------------------*/
+
+static bool consumeOne(void)
+{
+    uint8_t ch;
+    bool ok = Ring_Get(&ring, &ch);
+
+    if (ok)
+    {
+        CHECK(ch == seqByte(nextRead));
+        nextRead++;
+    }
+    return ok;
+}
+
+static void consumeSpan(void)
+{
+    const uint8_t *data;
+    uint16_t length = Ring_ReadSpan(&ring, &data);
+    uint16_t take = (length < amount) ? length : amount;
+
+    CHECK((data >= ringBuff) && ((data + length) <= (ringBuff + TEST_RING_SIZE)));
+    for (uint16_t i = 0; i < take; i++)
+    {
+        CHECK(data[i] == seqByte(nextRead + i));
+    }
+    Ring_Consume(&ring, take);
+    nextRead += take;
+}
+
+/* 생산자 --------------------------------------------------------------------*/
+
+static bool produceOne(void)
+{
+    bool ok = Ring_Put(&ring, seqByte(nextWrite));
+
+    if (ok)
+    {
+        nextWrite++;
+    }
+    return ok;
+}
+
+static void produceSpan(void)
+{
+    uint8_t *data;
+    uint16_t length = Ring_WriteSpan(&ring, &data);
+    uint16_t take = (length < amount) ? length : amount;
+
+    CHECK((data >= ringBuff) && ((data + length) <= (ringBuff + TEST_RING_SIZE)));
+    for (uint16_t i = 0; i < take; i++)
+    {
+        data[i] = seqByte(nextWrite + i);
+    }
+    Ring_Commit(&ring, take);
+    nextWrite += take;
+}
+
+/**
+ * @brief Circular DMA 가 amount 바이트를 받고 인터럽트에서 DMA 위치로 in 갱신.
+ *        DMA 는 읽지 않은 데이터를 덮어쓰지 않고, 한 바퀴 전에 동기화된다고 가정 (amount < 크기, 남은 공간 이하).
+ */
+static void produceDMA(void)
+{
+    uint16_t in = ring.in;
+    uint16_t free = Ring_Free(&ring);
+    uint16_t length = (amount < free) ? amount : free;
+
+    if (length >= TEST_RING_SIZE)
+    {
+        length = TEST_RING_SIZE - 1U;
+    }
+    for (uint16_t i = 0; i < length; i++)
+    {
+        ringBuff[(uint16_t)(in + i) & ring.mask] = seqByte(nextWrite + i);
+    }
+    Ring_SyncDMA(&ring, (uint16_t)((in + length) & ring.mask));
+    CHECK(ring.in == (uint16_t)(in + length));
+    nextWrite += length;
+}
+
+/* 시험 동작 -----------------------------------------------------------------*/
+
+static void mainGet(void)
+{
+    mainResult = consumeOne();
+}
+
+static void mainPut(void)
+{
+    mainResult = produceOne();
+}
+
+static void isrGet(void)
+{
+    isrResult = consumeOne();
+}
+
+static void isrPut(void)
+{
+    isrResult = produceOne();
+}
+
+static void mainReadSpan(void)
+{
+    consumeSpan();
+}
+
+static void mainWriteSpan(void)
+{
+    produceSpan();
+}
+
+static void isrReadSpan(void)
+{
+    consumeSpan();
+}
+
+static void isrWriteSpan(void)
+{
+    produceSpan();
+}
+
+static void mainDMA(void)
+{
+    produceDMA();
+}
+
+static void isrDMA(void)
+{
+    produceDMA();
+}
+
+static const testCase_TypeDef testCases[] = {
+    {"Get <- Put", mainGet, isrPut},
+    {"Put <- Get", mainPut, isrGet},
+    {"ReadSpan/Consume <- WriteSpan/Commit", mainReadSpan, isrWriteSpan},
+    {"WriteSpan/Commit <- ReadSpan/Consume", mainWriteSpan, isrReadSpan},
+    {"Get <- DMA/SyncDMA", mainGet, isrDMA},
+    {"ReadSpan/Consume <- DMA/SyncDMA", mainReadSpan, isrDMA},
+    {"DMA/SyncDMA <- Get", mainDMA, isrGet},
+    {"DMA/SyncDMA <- ReadSpan/Consume", mainDMA, isrReadSpan},
+};
+
+int main(void)
+{
+    struct sigaction action;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = onTrap;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGTRAP, &action, NULL) != 0)
+    {
+        perror("sigaction");
+        return 1;
+    }
+
+    for (size_t i = 0; i < (sizeof(testCases) / sizeof(testCases[0])); i++)
+    {
+        runCase(&testCases[i]);
+    }
+    testLines();
+    testLinesPreempted();
+
+    printf("ring_test: %llu preempted runs, %u failures\n", (unsigned long long)runs, failures);
+    return (failures == 0U) ? 0 : 1;
+}
+
+/**
+ * @brief 시작 인덱스, 저장된 갯수, 요청 길이의 모든 조합에서 모든 명령어 위치에 isr 을 끼워 넣어 실행
+ *
+ * @param test: 시험 항목
+ */
+static void runCase(const testCase_TypeDef *test)
+{
+    static const uint16_t bases[] = {0xFFF9U, 0xFFFCU, 0xFFFFU}; /* uint16 최대값 직전. 동작 중 in, out 이 0 으로 넘어감 */
+    static const uint16_t amounts[] = {0U, 1U, 3U, TEST_RING_SIZE};
+    size_t amountCount = (sizeof(amounts) / sizeof(amounts[0]));
+
+    if (((test->main == mainGet) || (test->main == mainPut)) && ((test->isr == isrGet) || (test->isr == isrPut)))
+    {
+        amountCount = 1U; /* Get, Put 은 요청 길이 없음 */
+    }
+
+    context = test->name;
+    for (size_t b = 0; b < (sizeof(bases) / sizeof(bases[0])); b++)
+    {
+        for (uint16_t fill = 0; fill <= TEST_RING_SIZE; fill++)
+        {
+            for (size_t a = 0; a < amountCount; a++)
+            {
+                uint32_t steps;
+
+                amount = amounts[a];
+
+                setup(bases[b], fill);
+                steps = runPreempted(test->main, test->isr, UINT32_MAX); /* 끼워 넣지 않고 명령어 수 측정 */
+                checkRing();
+
+                for (uint32_t at = 0; at <= steps; at++)
+                {
+                    setup(bases[b], fill);
+                    (void)runPreempted(test->main, test->isr, at);
+
+                    if ((test->main == mainGet) && !mainResult) /* 검사 전에 넣었으면 읽혀야 함 */
+                    {
+                        CHECK(preCount == 0U);
+                    }
+                    if ((test->main == mainPut) && !mainResult) /* 검사 전에 꺼냈으면 넣어져야 함 */
+                    {
+                        CHECK(preCount == TEST_RING_SIZE);
+                    }
+                    if ((test->isr == isrGet) && !isrResult)
+                    {
+                        CHECK(preCount == 0U);
+                    }
+                    if ((test->isr == isrPut) && !isrResult)
+                    {
+                        CHECK(preCount == TEST_RING_SIZE);
+                    }
+                    checkRing();
+                    runs++;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief 저장된 갯수가 순번 차이와 같고 남은 데이터가 순서대로인지 확인
+ *
+ */
+static void checkRing(void)
+{
+    uint8_t ch;
+
+    CHECK(Ring_Count(&ring) == (uint16_t)(nextWrite - nextRead));
+    CHECK(Ring_Count(&ring) <= TEST_RING_SIZE);
+    CHECK(Ring_Free(&ring) == (uint16_t)(TEST_RING_SIZE - Ring_Count(&ring)));
+    while (Ring_Get(&ring, &ch))
+    {
+        CHECK(ch == seqByte(nextRead));
+        nextRead++;
+    }
+    CHECK(nextRead == nextWrite);
+}
+
+/**
+ * @brief out 을 base 로 두고 fill 갯수만큼 채움. 나머지 칸은 TEST_EMPTY_BYTE.
+ *
+ * @param base: 시작 out
+ * @param fill: 저장된 갯수
+ */
+static void setup(uint16_t base, uint16_t fill)
+{
+    Ring_Init(&ring, ringBuff, TEST_RING_SIZE);
+    memset(ringBuff, TEST_EMPTY_BYTE, sizeof(ringBuff));
+    nextRead = 0x1000U + base;
+    nextWrite = nextRead + fill;
+    ring.out = base;
+    ring.in = (uint16_t)(base + fill);
+    for (uint16_t i = 0; i < fill; i++)
+    {
+        ringBuff[(uint16_t)(base + i) & ring.mask] = seqByte(nextRead + i);
+    }
+    preCount = fill;
+    mainResult = false;
+    isrResult = false;
+}
+
+/**
+ * @brief main 을 단일 단계로 실행하며 at 번째 명령어 뒤에서 isr 실행. at 이 명령어 수 이상이면 main 후에 실행.
+ *
+ * @param main: 사용자 Loop 쪽 동작
+ * @param isr: 인터럽트 쪽 동작
+ * @param at: isr 실행 위치
+ * @return uint32_t: main 의 명령어 수
+ */
+static uint32_t runPreempted(testStep main, testStep isr, uint32_t at)
+{
+    uint32_t steps;
+
+    stepCount = 0U;
+    injectAt = at;
+    injected = false;
+    injectStep = isr;
+
+    __asm__ volatile("pushfq\n\torq $0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc"); /* EFLAGS.TF */
+    main();
+    __asm__ volatile("pushfq\n\tandq $~0x100, (%%rsp)\n\tpopfq" ::: "memory", "cc");
+
+    steps = stepCount;
+    if (!injected)
+    {
+        injected = true;
+        isr();
+    }
+    return steps;
+}
+
+/**
+ * @brief 단일 단계 예외. 명령어 하나 실행마다 호출.
+ */
+static void onTrap(int sig, siginfo_t *info, void *ucontext)
+{
+    if (!injected && (stepCount == injectAt))
+    {
+        injected = true;
+        injectStep();
+    }
+    stepCount++;
+}
+
+/* getLineFromBuffer ---------------------------------------------------------*/
+
+static uartFIFO_TypeDef lineBuffer;
+
+/**
+ * @brief DMA 가 text 를 받고 in 갱신
+ *
+ * @return bool: Ring_SyncDMA() 결과. 읽지 않은 데이터를 덮어쓰면 false
+ */
+static bool receive(const char *text)
+{
+    uint16_t in = lineBuffer.ring.in;
+    uint16_t length = (uint16_t)strlen(text);
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        lineBuffer.buff[(uint16_t)(in + i) & (UART_BUFFER_SIZE - 1U)] = (uint8_t)text[i];
+    }
+    return Ring_SyncDMA(&lineBuffer.ring, (uint16_t)((in + length) & (UART_BUFFER_SIZE - 1U)));
+}
+
+/**
+ * @brief 비어 있는 버퍼의 out, in, scan 을 index 로 둠
+ */
+static void startLines(uint16_t index)
+{
+    initBuffer(&lineBuffer);
+    lineBuffer.ring.in = index;
+    lineBuffer.ring.out = index;
+    lineBuffer.scan = index;
+}
+
+/**
+ * @brief 꺼낸 줄이 text 이고 조각 길이가 first, second 인지 확인
+ */
+static void expectLine(const char *text, uint16_t first, uint16_t second)
+{
+    uartLine_TypeDef line;
+    uint16_t length = (uint16_t)strlen(text);
+
+    if (getLineFromBuffer(&lineBuffer, &line) != SUCCESS)
+    {
+        failure(__LINE__, text);
+        return;
+    }
+    CHECK(getLineLength(&line) == length);
+    CHECK((line.length[0] == first) && (line.length[1] == second));
+    CHECK((second == 0U) ? (line.data[1] == NULL) : (line.data[1] == lineBuffer.buff));
+    for (uint16_t i = 0; i < length; i++)
+    {
+        CHECK(getLineChar(&line, i) == (uint8_t)text[i]);
+    }
+    CHECK(getLineChar(&line, length) == 0U);
+}
+
+/**
+ * @brief 꺼낼 줄이 없는지 확인
+ */
+static void expectNoLine(void)
+{
+    uartLine_TypeDef line;
+
+    CHECK(getLineFromBuffer(&lineBuffer, &line) == ERROR);
+}
+
+/**
+ * @brief 링 버퍼 끝에서 나뉜 줄, CR LF 가 끝에서 나뉜 경우, 빈 줄, 나누어 수신된 줄, 줄바꿈 없는 긴 줄,
+ *        읽기 전에 DMA 가 덮어쓴 경우
+ *
+ */
+static void testLines(void)
+{
+    static char longLine[UART_LINE_MAX_SIZE + 8U];
+
+    context = "getLineFromBuffer";
+
+    startLines((uint16_t)(0x10000U - 4U)); /* 버퍼 1020, uint16 최대값 직전 */
+    receive("AT+TEST\r\n");
+    expectLine("AT+TEST", 4U, 3U);
+    CHECK(lineBuffer.ring.out == 5U);
+    expectNoLine();
+
+    startLines(UART_BUFFER_SIZE - 3U); /* "OK\r" 가 버퍼 끝, "\n" 이 처음 */
+    receive("OK\r\n");
+    expectLine("OK", 2U, 0U);
+    expectNoLine();
+
+    startLines(UART_BUFFER_SIZE - 2U); /* CR LF 모두 버퍼 처음 */
+    receive("ABC\r\n");
+    expectLine("ABC", 2U, 1U);
+
+    startLines(UART_BUFFER_SIZE - 4U); /* "\r" 까지 버퍼 끝, "\n" 은 나중에 수신 */
+    receive("ERR\r");
+    expectNoLine();
+    receive("\n");
+    expectLine("ERR", 3U, 0U);
+
+    startLines((uint16_t)(0x10000U - 6U)); /* 빈 줄 건너뜀 */
+    receive("\r\n\r\n+CEREG: 0,1\r\n\r\nOK\r\n");
+    expectLine("+CEREG: 0,1", 2U, 9U);
+    expectLine("OK", 2U, 0U);
+    expectNoLine();
+
+    startLines(UART_BUFFER_SIZE - 1U); /* 나누어 수신 */
+    receive("*WHTT");
+    expectNoLine();
+    receive("PR: COMPLETED,200");
+    expectNoLine();
+    receive("\r\n");
+    expectLine("*WHTTPR: COMPLETED,200", 1U, 21U);
+
+    startLines(UART_BUFFER_SIZE - 100U); /* 줄바꿈 없이 UART_LINE_MAX_SIZE 이상 수신한 만큼 한 줄 */
+    memset(longLine, 'x', UART_LINE_MAX_SIZE + 4U);
+    longLine[UART_LINE_MAX_SIZE + 4U] = '\0';
+    receive(longLine);
+    expectLine(longLine, 100U, UART_LINE_MAX_SIZE + 4U - 100U);
+    expectNoLine();
+
+    startLines((uint16_t)(0x10000U - 8U)); /* 읽지 않고 가득 찬 후 더 수신. 모두 버리고 다음 수신부터 */
+    memset(longLine, 'y', UART_LINE_MAX_SIZE - 8U);
+    longLine[UART_LINE_MAX_SIZE - 8U] = '\0';
+    CHECK(receive(longLine));
+    CHECK(receive(longLine));
+    CHECK(receive("0123456789ABCDEF"));
+    CHECK(!Ring_IsOverrun(&lineBuffer.ring));
+    CHECK(!receive("\r\n"));
+    CHECK(Ring_IsOverrun(&lineBuffer.ring));
+    CHECK(receive("+CEREG")); /* 버리기 전에는 다시 알리지 않음 */
+    expectNoLine();
+    CHECK(Ring_Count(&lineBuffer.ring) == 0U);
+    receive("OK\r\n");
+    expectLine("OK", 2U, 0U);
+    expectNoLine();
+}
+
+static const char *const lineChunks[] = {"\r\nOK\r", "\n\r\n+CPIN: READY\r\n", "\r\nO", "K\r\n*WHTTPR: START\r\n"};
+static const char *const lineExpected[] = {"OK", "+CPIN: READY", "OK", "*WHTTPR: START"};
+static uartLine_TypeDef lines[8]; /*!< 꺼낸 줄. 단일 단계 실행 구간을 줄이기 위해 비교는 나중에 */
+static uint8_t lineChunk;          /*!< 다음에 수신할 조각 */
+static uint8_t lineCount;          /*!< 꺼낸 줄 수 */
+
+static void collectLines(void)
+{
+    while ((lineCount < (sizeof(lines) / sizeof(lines[0]))) && (getLineFromBuffer(&lineBuffer, &lines[lineCount]) == SUCCESS))
+    {
+        lineCount++;
+    }
+}
+
+/**
+ * @brief 꺼낸 줄이 순서대로 lineExpected 와 같은지 확인
+ */
+static bool matchLines(void)
+{
+    if (lineCount != (sizeof(lineExpected) / sizeof(lineExpected[0])))
+    {
+        return false;
+    }
+    for (uint8_t n = 0; n < lineCount; n++)
+    {
+        uint16_t length = getLineLength(&lines[n]);
+
+        if (length != strlen(lineExpected[n]))
+        {
+            return false;
+        }
+        for (uint16_t i = 0; i < length; i++)
+        {
+            if (getLineChar(&lines[n], i) != (uint8_t)lineExpected[n][i])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void receiveChunk(void)
+{
+    receive(lineChunks[lineChunk++]);
+}
+
+/**
+ * @brief 줄 분리 중 모든 명령어 위치에 DMA 수신을 끼워 넣고 꺼낸 줄이 순서대로 모두 같은지 확인.
+ *        줄이 버퍼 끝에 걸치도록 시작 위치를 바꿈.
+ *
+ */
+static void testLinesPreempted(void)
+{
+    context = "getLineFromBuffer <- DMA/SyncDMA";
+
+    for (uint16_t start = 0; start < 24U; start += 3U)
+    {
+        uint32_t steps;
+        uint16_t index = (uint16_t)(0x10000U - 16U + start); /* 버퍼 끝과 uint16 최대값 근처 */
+
+        for (uint32_t at = 0;; at++)
+        {
+            startLines(index);
+            lineChunk = 0U;
+            lineCount = 0U;
+            receiveChunk();
+            receiveChunk();
+            steps = runPreempted(collectLines, receiveChunk, at);
+            collectLines();
+            receiveChunk();
+            collectLines();
+
+            CHECK(matchLines());
+            CHECK(Ring_Count(&lineBuffer.ring) == 0U);
+            runs++;
+            if (at >= steps)
+            {
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 실패 출력. 같은 항목은 처음 몇 개만.
+ */
+static void failure(int line, const char *text)
+{
+    if (failures++ < 20U)
+    {
+        fprintf(stderr, "ring_test.c:%d: %s: CHECK(%s) failed (out %u, in %u, amount %u, at %u)\n", line, context, text,
+                ring.out, ring.in, amount, injectAt);
+    }
+}
+
+/**
+ * @brief 순번의 바이트 값
+ */
+static uint8_t seqByte(uint32_t seq)
+{
+    return (uint8_t)((seq * 37U) ^ (seq >> 8));
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""LPS_LTE 바이너리 로그 디코더
+
+펌웨어 ELF 의 .logfmt 섹션에서 형식 문자열을 읽어 UART2 로 수신한 로그를 문자열로 변환.
+
+레코드: 0xA5 | 레벨<<4 + 인자 갯수 | 형식 ID(2) | 시각 ms(4) | 인자(4 x n), little endian
+
+사용 예:
+    python3 logdecode.py LPS_LTE.elf capture.bin
+    python3 logdecode.py LPS_LTE.elf /dev/ttyUSB0 --baud 115200   (pyserial 필요)
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+LOG_SYNC = 0xA5
+LOG_ARGS_MAX = 4
+LEVELS = ("ERROR", "WARN", "INFO", "DEBUG")
+
+CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z)?([diuxXcfeEgGp%])")
+
+
+def load_formats(path):
+    """ELF32 에서 .logfmt 섹션 내용을 읽음"""
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1:
+        raise ValueError("not an ELF32 file: " + path)
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+
+    def section(index):
+        return struct.unpack_from("<IIIIII", elf, shoff + index * shentsize)
+
+    names = section(shstrndx)
+    for i in range(shnum):
+        name, _, _, addr, offset, size = section(i)
+        end = elf.index(b"\0", names[4] + name)
+        if elf[names[4] + name:end] == b".logfmt":
+            return addr, elf[offset:offset + size]
+    raise ValueError(".logfmt section not found in " + path)
+
+
+def format_string(formats, fid):
+    base, data = formats
+    start = fid - base
+    if start < 0 or start >= len(data):
+        return None
+    end = data.find(b"\0", start)
+    return data[start:end if end >= 0 else len(data)].decode("utf-8", "replace")
+
+
+def render(fmt, args):
+    """C printf 형식을 32bit 인자로 변환"""
+    values = iter(args)
+
+    def convert(match):
+        flags, conv = match.group(1), match.group(2)
+        if conv == "%":
+            return "%"
+        raw = next(values, 0)
+        if conv in "di":
+            value = raw - (1 << 32) if raw & 0x80000000 else raw
+            conv = "d"
+        elif conv == "u":
+            value, conv = raw, "d"
+        elif conv in "feEgG":
+            value, = struct.unpack("<f", struct.pack("<I", raw))
+        elif conv == "p":
+            value, flags, conv = raw, "#0" + (flags or "10"), "x"
+        else:
+            value = raw
+        return ("%" + flags + conv) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(formats, stream, out):
+    buf = bytearray()
+    while True:
+        chunk = stream.read(max(1, stream.in_waiting) if hasattr(stream, "in_waiting") else 64)
+        if not chunk:
+            break
+        buf += chunk
+        while len(buf) >= 8:
+            if buf[0] != LOG_SYNC:
+                del buf[0]
+                continue
+            meta = buf[1]
+            level, argc = meta >> 4, meta & 0x0F
+            fid, tick = struct.unpack_from("<HI", buf, 2)
+            fmt = format_string(formats, fid)
+            if level >= len(LEVELS) or argc > LOG_ARGS_MAX or fmt is None:
+                del buf[0]  # 잘못된 시작 바이트, 다시 동기화
+                continue
+            length = 8 + argc * 4
+            if len(buf) < length:
+                break
+            args = struct.unpack_from("<%dI" % argc, buf, 8)
+            out.write("%10.3f %-5s %s\n" % (tick / 1000.0, LEVELS[level], render(fmt, args)))
+            out.flush()
+            del buf[:length]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="펌웨어 ELF 파일")
+    parser.add_argument("input", nargs="?", default="-", help="캡처 파일, 시리얼 포트 또는 - (stdin)")
+    parser.add_argument("--baud", type=int, default=115200, help="시리얼 포트 속도")
+    args = parser.parse_args()
+
+    formats = load_formats(args.elf)
+    if args.input == "-":
+        stream = sys.stdin.buffer
+    elif args.input.startswith(("/dev/", "COM")):
+        import serial  # pyserial
+        stream = serial.Serial(args.input, args.baud, timeout=None)
+    else:
+        stream = open(args.input, "rb")
+    try:
+        decode(formats, stream, sys.stdout)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
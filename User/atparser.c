@@ -0,0 +1,329 @@
+/**
+  ******************************************************************************
+  * @file    atparser.c
+  * @author  정두원
+  * @date    2020-11-20
+  * @brief   LTE 모뎀 AT 응답 분석
+  * @details 응답 접두어를 컴파일 시 만들어진 트라이(trie) 테이블로 한 번에 분류하고,
+  *          이어서 같은 위치부터 파라미터를 읽어 한 줄을 한 번만 검사함.
+  */
+
+#include <string.h>
+#include "atparser.h"
+
+/** @defgroup ATPARSER AT 응답 분석 함수
+  * @brief LTE 모뎀 응답 분류 및 파라미터 분석
+  * @{
+  */
+
+typedef struct
+{
+    char ch;             /*!< 이 노드의 문자 */
+    uint8_t child;       /*!< 첫번째 자식 노드 인덱스. 자식 노드는 연속으로 배치 */
+    uint8_t childCount;  /*!< 자식 노드 갯수 */
+    atResponseType type; /*!< 여기까지 일치하면 인식되는 응답. 없으면 AT_RSP_NONE */
+} atTrieNode_TypeDef;    /*!< 응답 접두어 트라이 노드 */
+
+typedef struct
+{
+    const uartLine_TypeDef *line;
+    uint16_t index;
+    uint16_t length;
+} atCursor_TypeDef; /*!< 줄 읽기 위치 */
+
+/* Private variables ---------------------------------------------------------*/
+#define AT_TRIE_ROOT_COUNT 5U /*!< 최상위 노드 갯수: 'O', 'E', '+', '*', '$' */
+
+/**
+ * @brief 응답 접두어 트라이. 형제 노드를 연속으로 배치하여 노드당 자식 범위만 검사.
+ * @note  OK, ERROR, +CME ERROR, +CPIN, +CEREG, *WWANIP, *WHTTPR, *WHTTP, $$MSTIME
+ */
+static const atTrieNode_TypeDef atTrie[] = {
+    {'O', 5, 1U, AT_RSP_NONE},        /*  0: "O" */
+    {'E', 6, 1U, AT_RSP_NONE},        /*  1: "E" */
+    {'+', 7, 1U, AT_RSP_NONE},        /*  2: "+" */
+    {'*', 8, 1U, AT_RSP_NONE},        /*  3: "*" */
+    {'$', 9, 1U, AT_RSP_NONE},        /*  4: "$" */
+    {'K', 0, 0U, AT_RSP_OK},          /*  5: "OK" */
+    {'R', 10, 1U, AT_RSP_NONE},       /*  6: "ER" */
+    {'C', 11, 3U, AT_RSP_NONE},       /*  7: "+C" */
+    {'W', 14, 2U, AT_RSP_NONE},       /*  8: "*W" */
+    {'$', 16, 1U, AT_RSP_NONE},       /*  9: "$$" */
+    {'R', 17, 1U, AT_RSP_NONE},       /* 10: "ERR" */
+    {'M', 18, 1U, AT_RSP_NONE},       /* 11: "+CM" */
+    {'P', 19, 1U, AT_RSP_NONE},       /* 12: "+CP" */
+    {'E', 20, 1U, AT_RSP_NONE},       /* 13: "+CE" */
+    {'W', 21, 1U, AT_RSP_NONE},       /* 14: "*WW" */
+    {'H', 22, 1U, AT_RSP_NONE},       /* 15: "*WH" */
+    {'M', 23, 1U, AT_RSP_NONE},       /* 16: "$$M" */
+    {'O', 24, 1U, AT_RSP_NONE},       /* 17: "ERRO" */
+    {'E', 25, 1U, AT_RSP_NONE},       /* 18: "+CME" */
+    {'I', 26, 1U, AT_RSP_NONE},       /* 19: "+CPI" */
+    {'R', 27, 1U, AT_RSP_NONE},       /* 20: "+CER" */
+    {'A', 28, 1U, AT_RSP_NONE},       /* 21: "*WWA" */
+    {'T', 29, 1U, AT_RSP_NONE},       /* 22: "*WHT" */
+    {'S', 30, 1U, AT_RSP_NONE},       /* 23: "$$MS" */
+    {'R', 0, 0U, AT_RSP_ERROR},       /* 24: "ERROR" */
+    {' ', 31, 1U, AT_RSP_NONE},       /* 25: "+CME " */
+    {'N', 0, 0U, AT_RSP_CPIN},        /* 26: "+CPIN" */
+    {'E', 32, 1U, AT_RSP_NONE},       /* 27: "+CERE" */
+    {'N', 33, 1U, AT_RSP_NONE},       /* 28: "*WWAN" */
+    {'T', 34, 1U, AT_RSP_NONE},       /* 29: "*WHTT" */
+    {'T', 35, 1U, AT_RSP_NONE},       /* 30: "$$MST" */
+    {'E', 36, 1U, AT_RSP_NONE},       /* 31: "+CME E" */
+    {'G', 0, 0U, AT_RSP_CEREG},       /* 32: "+CEREG" */
+    {'I', 37, 1U, AT_RSP_NONE},       /* 33: "*WWANI" */
+    {'P', 38, 1U, AT_RSP_WHTTP},      /* 34: "*WHTTP" */
+    {'I', 39, 1U, AT_RSP_NONE},       /* 35: "$$MSTI" */
+    {'R', 40, 1U, AT_RSP_NONE},       /* 36: "+CME ER" */
+    {'P', 0, 0U, AT_RSP_WWANIP},      /* 37: "*WWANIP" */
+    {'R', 0, 0U, AT_RSP_WHTTPR},      /* 38: "*WHTTPR" */
+    {'M', 41, 1U, AT_RSP_NONE},       /* 39: "$$MSTIM" */
+    {'R', 42, 1U, AT_RSP_NONE},       /* 40: "+CME ERR" */
+    {'E', 0, 0U, AT_RSP_MSTIME},      /* 41: "$$MSTIME" */
+    {'O', 43, 1U, AT_RSP_NONE},       /* 42: "+CME ERRO" */
+    {'R', 0, 0U, AT_RSP_CME_ERROR}    /* 43: "+CME ERROR" */
+};
+
+/* Private functions ---------------------------------------------------------*/
+static atResponseType matchPrefix(atCursor_TypeDef *cursor);
+static void skipSeparator(atCursor_TypeDef *cursor);
+static bool matchWord(atCursor_TypeDef *cursor, const char *word);
+static uint8_t readValues(atCursor_TypeDef *cursor, int32_t *value, uint8_t maxCount);
+
+/**
+ * @brief LTE 모뎀 응답 한 줄 분석
+ *
+ * @param line: getLineFromBuffer() 로 꺼낸 줄
+ * @param response: 분석 결과
+ */
+void AT_ParseLine(const uartLine_TypeDef *line, atResponse_TypeDef *response)
+{
+    atCursor_TypeDef cursor = {line, 0U, getLineLength(line)};
+    int32_t value[AT_VALUE_MAX];
+    uint8_t count;
+
+    memset(response, 0, sizeof(atResponse_TypeDef));
+    response->type = matchPrefix(&cursor);
+    skipSeparator(&cursor);
+
+    switch (response->type)
+    {
+    case AT_RSP_OK:
+    case AT_RSP_ERROR:
+        if (cursor.index != cursor.length) /* 최종 응답은 줄 전체가 일치해야 함 */
+        {
+            response->type = AT_RSP_UNKNOWN;
+        }
+        break;
+    case AT_RSP_CME_ERROR:
+        if (readValues(&cursor, value, 1U) == 1U)
+        {
+            response->param.cme.code = (uint16_t)value[0];
+        }
+        break;
+    case AT_RSP_CPIN:
+        response->param.cpin.ready = matchWord(&cursor, "READY");
+        break;
+    case AT_RSP_CEREG:
+        count = readValues(&cursor, value, 2U);
+        if (count == 2U) /* 조회 응답 +CEREG: <n>,<stat> */
+        {
+            response->param.cereg.n = (uint8_t)value[0];
+            response->param.cereg.stat = (uint8_t)value[1];
+        }
+        else if (count == 1U) /* URC +CEREG: <stat> */
+        {
+            response->param.cereg.stat = (uint8_t)value[0];
+        }
+        break;
+    case AT_RSP_WWANIP:
+        for (count = 0U; (count < AT_IP_MAX_LENGTH) && (cursor.index < cursor.length); count++)
+        {
+            char ch = (char)getLineChar(line, cursor.index);
+            if ((ch == ',') || (ch == ' '))
+            {
+                break;
+            }
+            response->param.wwanip.ip[count] = ch;
+            cursor.index++;
+        }
+        break;
+    case AT_RSP_WHTTPR:
+        if (matchWord(&cursor, "START"))
+        {
+            response->param.whttpr.state = AT_HTTP_START;
+        }
+        else if (matchWord(&cursor, "COMPLETED"))
+        {
+            response->param.whttpr.state = AT_HTTP_COMPLETED;
+        }
+        count = readValues(&cursor, value, AT_VALUE_MAX);
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if ((value[i] >= 100) && (value[i] <= 599)) /* HTTP 상태 코드 */
+            {
+                response->param.whttpr.status = (uint16_t)value[i];
+                break;
+            }
+        }
+        break;
+    case AT_RSP_WHTTP:
+    case AT_RSP_MSTIME:
+        response->param.values.count = readValues(&cursor, response->param.values.value, AT_VALUE_MAX);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief ERROR, +CME ERROR 응답인지 확인
+ *
+ * @param response: 분석된 응답
+ * @return true: 에러 최종 응답
+ */
+bool AT_IsErrorResult(const atResponse_TypeDef *response)
+{
+    return (response->type == AT_RSP_ERROR) || (response->type == AT_RSP_CME_ERROR);
+}
+
+/**
+ * @brief 트라이를 따라가며 가장 길게 일치하는 응답 접두어 검색
+ *
+ * @param cursor: 줄 읽기 위치. 일치한 접두어 다음으로 이동
+ * @return atResponseType: 일치하는 접두어가 없으면 AT_RSP_UNKNOWN
+ */
+static atResponseType matchPrefix(atCursor_TypeDef *cursor)
+{
+    atResponseType type = AT_RSP_UNKNOWN;
+    uint16_t matchedIndex = 0U;
+    uint8_t first = 0U;
+    uint8_t count = AT_TRIE_ROOT_COUNT;
+
+    while ((count != 0U) && (cursor->index < cursor->length))
+    {
+        char ch = (char)getLineChar(cursor->line, cursor->index);
+        uint8_t node = first;
+
+        while ((node < (first + count)) && (atTrie[node].ch != ch))
+        {
+            node++;
+        }
+        if (node == (first + count)) /* 일치하는 자식 노드 없음 */
+        {
+            break;
+        }
+
+        cursor->index++;
+        if (atTrie[node].type != AT_RSP_NONE)
+        {
+            type = atTrie[node].type;
+            matchedIndex = cursor->index;
+        }
+        first = atTrie[node].child;
+        count = atTrie[node].childCount;
+    }
+
+    cursor->index = matchedIndex; /* 마지막으로 인식된 접두어 다음 위치 */
+    return type;
+}
+
+/**
+ * @brief 접두어 뒤의 ':' 및 공백 건너뛰기
+ *
+ * @param cursor: 줄 읽기 위치
+ */
+static void skipSeparator(atCursor_TypeDef *cursor)
+{
+    while (cursor->index < cursor->length)
+    {
+        char ch = (char)getLineChar(cursor->line, cursor->index);
+        if ((ch != ':') && (ch != ' '))
+        {
+            break;
+        }
+        cursor->index++;
+    }
+}
+
+/**
+ * @brief 현재 위치의 단어 비교. 일치하면 단어 다음으로 이동.
+ *
+ * @param cursor: 줄 읽기 위치
+ * @param word: 비교할 단어
+ * @return true: 일치
+ */
+static bool matchWord(atCursor_TypeDef *cursor, const char *word)
+{
+    uint16_t index = cursor->index;
+
+    while (*word != '\0')
+    {
+        if ((index >= cursor->length) || (getLineChar(cursor->line, index) != (uint8_t)*word))
+        {
+            return false;
+        }
+        index++;
+        word++;
+    }
+
+    cursor->index = index;
+    return true;
+}
+
+/**
+ * @brief 숫자 파라미터 읽기. ',', '/', ':' 등 숫자가 아닌 문자는 구분자로 처리.
+ *
+ * @param cursor: 줄 읽기 위치
+ * @param value: 읽은 값 저장 배열
+ * @param maxCount: 최대 갯수
+ * @return uint8_t: 읽은 값 갯수
+ */
+static uint8_t readValues(atCursor_TypeDef *cursor, int32_t *value, uint8_t maxCount)
+{
+    uint8_t count = 0U;
+
+    while ((count < maxCount) && (cursor->index < cursor->length))
+    {
+        char ch = (char)getLineChar(cursor->line, cursor->index);
+        bool negative = false;
+
+        if ((ch == '-') && ((cursor->index + 1U) < cursor->length))
+        {
+            char next = (char)getLineChar(cursor->line, cursor->index + 1U);
+            if ((next >= '0') && (next <= '9'))
+            {
+                negative = true;
+                cursor->index++;
+                ch = next;
+            }
+        }
+
+        if ((ch >= '0') && (ch <= '9'))
+        {
+            int32_t number = 0;
+            while (cursor->index < cursor->length)
+            {
+                ch = (char)getLineChar(cursor->line, cursor->index);
+                if ((ch < '0') || (ch > '9'))
+                {
+                    break;
+                }
+                number = (number * 10) + (ch - '0');
+                cursor->index++;
+            }
+            value[count++] = negative ? -number : number;
+        }
+        else
+        {
+            cursor->index++;
+        }
+    }
+
+    return count;
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,72 @@
+#ifndef ATPARSER_H__
+#define ATPARSER_H__ 1
+
+#include <stdbool.h>
+#include "main.h"
+#include "uart.h"
+
+#define AT_IP_MAX_LENGTH 39U /*!< IPv6 주소 최대 길이 */
+#define AT_VALUE_MAX 6U      /*!< 숫자 파라미터 최대 갯수 */
+
+typedef enum
+{
+    AT_RSP_NONE = 0,   /*!< 응답 없음 */
+    AT_RSP_UNKNOWN,    /*!< 분류되지 않은 줄 (HTTP 본문, 미사용 URC 등) */
+    AT_RSP_OK,         /*!< 최종 응답 OK */
+    AT_RSP_ERROR,      /*!< 최종 응답 ERROR */
+    AT_RSP_CME_ERROR,  /*!< 최종 응답 +CME ERROR: <code> */
+    AT_RSP_CPIN,       /*!< +CPIN: <code> */
+    AT_RSP_CEREG,      /*!< +CEREG: <n>,<stat> */
+    AT_RSP_WWANIP,     /*!< *WWANIP: <ip> */
+    AT_RSP_WHTTPR,     /*!< *WHTTPR: <state|status> */
+    AT_RSP_WHTTP,      /*!< *WHTTP: <values> */
+    AT_RSP_MSTIME      /*!< $$MSTIME: <values> */
+} atResponseType; /*!< LTE 모뎀 응답 종류 */
+
+typedef enum
+{
+    AT_HTTP_OTHER = 0, /*!< 상태 문자열 없음 */
+    AT_HTTP_START,     /*!< 전송 시작 */
+    AT_HTTP_COMPLETED  /*!< 전송 완료 */
+} atHttpState; /*!< *WHTTPR 상태 */
+
+typedef struct
+{
+    atResponseType type;
+    union
+    {
+        struct
+        {
+            bool ready; /*!< SIM 준비 완료 */
+        } cpin;
+        struct
+        {
+            uint8_t n;
+            uint8_t stat; /*!< 1: 홈 네트워크 등록, 5: 로밍 등록 */
+        } cereg;
+        struct
+        {
+            char ip[AT_IP_MAX_LENGTH + 1U];
+        } wwanip;
+        struct
+        {
+            atHttpState state;
+            uint16_t status; /*!< HTTP 상태 코드. 없으면 0 */
+        } whttpr;
+        struct
+        {
+            uint16_t code;
+        } cme;
+        struct
+        {
+            uint8_t count;
+            int32_t value[AT_VALUE_MAX];
+        } values; /*!< *WHTTP, $$MSTIME */
+    } param;
+} atResponse_TypeDef; /*!< 분석된 LTE 모뎀 응답 */
+
+/* Extern functions ---------------------------------------------------------*/
+void AT_ParseLine(const uartLine_TypeDef *line, atResponse_TypeDef *response); /*!< 응답 한 줄 분석 */
+bool AT_IsErrorResult(const atResponse_TypeDef *response);                     /*!< ERROR, +CME ERROR 여부 */
+
+#endif /* ATPARSER_H__ */
@@ -0,0 +1,31 @@
+#ifndef BACKUP_H__
+#define BACKUP_H__ 1
+
+#include "main.h"
+
+/**
+ * @brief RTC 백업 레지스터 배치. 스탠바이 모드에서도 유지됨.
+ *
+ *  DR0         : 압축 센싱 값 헤더 (pack.c)
+ *  DR1  ~ DR7  : 압축 센싱 값
+ *  DR8         : 재전송 상태 (retry.c)
+ *  DR9         : LTE 모뎀 링크 설정 (통신 속도)
+ *  DR10 ~ DR17 : 압축 센싱 값
+ *  DR18        : LTE 모뎀 UART 에러 횟수 (DMA << 24 | 노이즈 << 16 | 프레임 << 8 | 오버런)
+ *  DR19        : 배터리 교체 후 경과 시간 (초)
+ *  DR20 ~ DR27 : 압축 센싱 값
+ *  DR28 ~ DR29 : 배터리 교체 후 누적 전하량 (nC, 64비트. DR28 하위, DR29 상위)
+ *  DR30        : 전송 횟수
+ *  DR31        : 전송 실패 횟수 << 16 | 전송하지 않은 센싱 횟수
+ */
+#define BKP_PACK RTC_BKP_DR0        /*!< 압축 센싱 값 헤더 */
+#define BKP_RETRY RTC_BKP_DR8       /*!< 재전송 상태 */
+#define BKP_LINK RTC_BKP_DR9        /*!< LTE 모뎀 링크 설정 */
+#define BKP_UART_ERROR RTC_BKP_DR18 /*!< LTE 모뎀 UART 에러 횟수 */
+#define BKP_ELAPSED RTC_BKP_DR19    /*!< 배터리 교체 후 경과 시간 */
+#define BKP_CHARGE_LOW RTC_BKP_DR28 /*!< 누적 전하량 하위 32비트 */
+#define BKP_CHARGE_HIGH RTC_BKP_DR29 /*!< 누적 전하량 상위 32비트 */
+#define BKP_SENDING RTC_BKP_DR30    /*!< 전송 횟수 */
+#define BKP_COUNT RTC_BKP_DR31      /*!< 전송 실패 횟수 << 16 | 전송하지 않은 센싱 횟수 */
+
+#endif /* BACKUP_H__ */
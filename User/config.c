@@ -0,0 +1,242 @@
+/**
+  ******************************************************************************
+  * @file    config.c
+  * @author  정두원
+  * @date    2020-12-24
+  * @brief   플래시 설정
+  * @details 센싱 주기, 전송 횟수, 서버 주소 등 운용 설정을 플래시 두 페이지(A, B)에 저장.
+  *          저장할 때는 사용 중이 아닌 페이지에 순번을 1 늘려 쓰므로, 쓰는 중 전원이 꺼져도 이전
+  *          설정이 남음. 부팅 시 CRC, 버전이 맞는 페이지 중 순번이 큰 쪽을 복사 없이 그대로 읽어 사용하고,
+  *          둘 다 유효하지 않으면 펌웨어 기본 값 사용.
+  */
+
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "crc.h"
+#include "log.h"
+
+/** @defgroup CONFIG 플래시 설정
+  * @brief A/B 두 벌, 버전, CRC 로 확인하는 운용 설정
+  * @{
+  */
+
+#define CONFIG_MAGIC 0x47464E43U /*!< 설정 유효 표시 "CNFG" */
+#define CONFIG_ADDRESS(page) (FLASH_BASE + ((page) * FLASH_PAGE_SIZE))
+
+_Static_assert((sizeof(config_TypeDef) % 8U) == 0U, "config_TypeDef must be a multiple of 8 bytes");
+
+/**
+ * @brief 펌웨어 기본 설정. 플래시에 유효한 설정이 없을 때 사용.
+ */
+static const config_TypeDef configDefault = {
+    .magic = CONFIG_MAGIC,
+    .version = CONFIG_VERSION,
+    .size = sizeof(config_TypeDef),
+    .sequence = 0U,
+    .wakeupInterval = 600U,
+    .sendingTimeout = 120000U,
+    .sensingTimes = CONFIG_SENSING_MAX,
+    .uploadBatch = 3U,
+    .retransmissions = 2U,
+    .url = "dbos.co.kr/smlf_api_v_2_1/test/set",
+};
+
+/* Private variables ---------------------------------------------------------*/
+static const config_TypeDef *config = &configDefault; /*!< 사용 중인 설정 */
+
+/* Private functions ---------------------------------------------------------*/
+static bool isValid(const config_TypeDef *stored);
+static bool parseValue(const char **text, uint32_t min, uint32_t max, uint32_t *value);
+static ErrorStatus writePage(uint8_t page, const config_TypeDef *stored);
+
+/**
+ * @brief A, B 중 유효하고 순번이 큰 설정 선택
+ *
+ */
+void Config_Init(void)
+{
+    const config_TypeDef *a = (const config_TypeDef *)CONFIG_ADDRESS(CONFIG_PAGE_A);
+    const config_TypeDef *b = (const config_TypeDef *)CONFIG_ADDRESS(CONFIG_PAGE_B);
+    bool validA = isValid(a);
+    bool validB = isValid(b);
+
+    if (validA && (!validB || ((int32_t)(a->sequence - b->sequence) > 0)))
+    {
+        config = a;
+    }
+    else if (validB)
+    {
+        config = b;
+    }
+    else
+    {
+        config = &configDefault;
+    }
+    LOG_INFO("config: sequence %u, wakeup %u s", config->sequence, config->wakeupInterval);
+}
+
+/**
+ * @brief 사용 중인 설정
+ *
+ * @return const config_TypeDef*: 플래시의 설정 또는 기본 설정
+ */
+const config_TypeDef *Config_Get(void)
+{
+    return config;
+}
+
+/**
+ * @brief 설정 저장. 사용 중이 아닌 페이지에 쓰고 그 설정으로 전환. magic, version, size, sequence,
+ *        crc 는 여기서 채움. 값의 범위는 Config_Parse() 에서 확인.
+ *
+ * @param newConfig: 저장할 설정
+ * @return ErrorStatus: 쓰기 실패하면 ERROR. 사용 중인 설정 유지
+ */
+ErrorStatus Config_Save(const config_TypeDef *newConfig)
+{
+    config_TypeDef stored = *newConfig;
+    uint8_t page = (config == (const config_TypeDef *)CONFIG_ADDRESS(CONFIG_PAGE_A)) ? CONFIG_PAGE_B : CONFIG_PAGE_A;
+
+    stored.magic = CONFIG_MAGIC;
+    stored.version = CONFIG_VERSION;
+    stored.size = sizeof(config_TypeDef);
+    stored.sequence = config->sequence + 1U;
+    memset(stored.reserved, 0, sizeof(stored.reserved));
+    stored.url[CONFIG_URL_MAX - 1U] = '\0';
+    stored.crc = Crc_Calculate32(&stored, offsetof(config_TypeDef, crc));
+
+    if ((writePage(page, &stored) != SUCCESS) || !isValid((const config_TypeDef *)CONFIG_ADDRESS(page)))
+    {
+        LOG_ERROR("config: save to page %u failed", page);
+        return ERROR;
+    }
+    config = (const config_TypeDef *)CONFIG_ADDRESS(page);
+    LOG_INFO("config: saved sequence %u", config->sequence);
+    return SUCCESS;
+}
+
+/**
+ * @brief 설정 명령 문자열 분석. "<wakeupInterval>,<sendingTimeout>,<sensingTimes>,<uploadBatch>,<retransmissions>[,<url>]"
+ *        url 을 생략하면 parsed 의 url 유지. 하나라도 범위를 벗어나면 parsed 는 바꾸지 않음.
+ *
+ * @param text: 명령 문자열 ('\0' 끝)
+ * @param parsed: 분석 결과. 사용 중인 설정의 복사본을 넘김
+ * @return ErrorStatus: 형식이 맞지 않거나 범위를 벗어나면 ERROR
+ */
+ErrorStatus Config_Parse(const char *text, config_TypeDef *parsed)
+{
+    uint32_t wakeupInterval, sendingTimeout, sensingTimes, uploadBatch, retransmissions;
+    size_t urlLength = 0U;
+
+    if (!parseValue(&text, 1U, 0xFFFFU, &wakeupInterval) || (*text++ != ',') || /* RTC 깨어남 타이머 16비트 */
+        !parseValue(&text, 1000U, 3600000U, &sendingTimeout) || (*text++ != ',') ||
+        !parseValue(&text, 1U, CONFIG_SENSING_MAX, &sensingTimes) || (*text++ != ',') ||
+        !parseValue(&text, 1U, CONFIG_BATCH_MAX, &uploadBatch) || (*text++ != ',') ||
+        !parseValue(&text, 1U, CONFIG_RETRANSMISSIONS_MAX, &retransmissions))
+    {
+        return ERROR;
+    }
+    if (*text == ',')
+    {
+        text++;
+        urlLength = strlen(text);
+        if ((urlLength == 0U) || (urlLength >= CONFIG_URL_MAX))
+        {
+            return ERROR;
+        }
+    }
+    else if (*text != '\0')
+    {
+        return ERROR;
+    }
+
+    parsed->wakeupInterval = wakeupInterval;
+    parsed->sendingTimeout = sendingTimeout;
+    parsed->sensingTimes = (uint16_t)sensingTimes;
+    parsed->uploadBatch = (uint16_t)uploadBatch;
+    parsed->retransmissions = (uint8_t)retransmissions;
+    if (urlLength != 0U)
+    {
+        memset(parsed->url, 0, sizeof(parsed->url));
+        memcpy(parsed->url, text, urlLength);
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 저장된 설정 확인
+ *
+ * @param stored: 플래시의 설정
+ * @return true: 표시, 버전, 크기, CRC 가 모두 맞음
+ */
+static bool isValid(const config_TypeDef *stored)
+{
+    return (stored->magic == CONFIG_MAGIC) && (stored->version == CONFIG_VERSION) &&
+           (stored->size == sizeof(config_TypeDef)) &&
+           (stored->crc == Crc_Calculate32(stored, offsetof(config_TypeDef, crc)));
+}
+
+/**
+ * @brief 10진수 하나 읽기
+ *
+ * @param text: 읽을 위치. 숫자 다음으로 이동
+ * @param min: 최소 값
+ * @param max: 최대 값
+ * @param value: 읽은 값
+ * @return true: 숫자가 있고 범위 안
+ */
+static bool parseValue(const char **text, uint32_t min, uint32_t max, uint32_t *value)
+{
+    char *end;
+    unsigned long number;
+
+    if ((**text < '0') || (**text > '9'))
+    {
+        return false;
+    }
+    number = strtoul(*text, &end, 10);
+    if ((number < min) || (number > max))
+    {
+        return false;
+    }
+    *value = (uint32_t)number;
+    *text = end;
+    return true;
+}
+
+/**
+ * @brief 페이지를 지우고 설정 쓰기
+ *
+ * @param page: CONFIG_PAGE_A 또는 CONFIG_PAGE_B
+ * @param stored: 저장할 설정
+ * @return ErrorStatus: 실패하면 ERROR
+ */
+static ErrorStatus writePage(uint8_t page, const config_TypeDef *stored)
+{
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t pageError;
+    uint64_t doubleWord;
+    HAL_StatusTypeDef status;
+
+    erase.TypeErase = FLASH_TYPEERASE_PAGES;
+    erase.Banks = FLASH_BANK_1;
+    erase.Page = page;
+    erase.NbPages = 1U;
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+    status = HAL_FLASHEx_Erase(&erase, &pageError);
+    for (uint32_t offset = 0; (status == HAL_OK) && (offset < sizeof(config_TypeDef)); offset += 8U)
+    {
+        memcpy(&doubleWord, (const uint8_t *)stored + offset, sizeof(doubleWord));
+        status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, CONFIG_ADDRESS(page) + offset, doubleWord);
+    }
+    HAL_FLASH_Lock();
+
+    return (status == HAL_OK) ? SUCCESS : ERROR;
+}
+
+/**
+  * @}
+  */
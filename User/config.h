@@ -0,0 +1,38 @@
+#ifndef CONFIG_H__
+#define CONFIG_H__ 1
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "main.h"
+
+#define CONFIG_PAGE_A 46U    /*!< 설정 A 페이지 번호. 링커 스크립트의 FLASH 영역(92K) 바로 뒤 */
+#define CONFIG_PAGE_B 47U    /*!< 설정 B 페이지 번호. 플래시 로그(FLASHLOG_FIRST_PAGE) 바로 앞 */
+#define CONFIG_VERSION 1U    /*!< 설정 구조 버전. 항목을 바꾸면 증가, 다른 버전은 사용하지 않음 */
+#define CONFIG_URL_MAX 80U   /*!< 서버 주소 최대 길이 ('\0' 포함) */
+#define CONFIG_SENSING_MAX 6U /*!< 한 번에 전송하는 최대 센싱 횟수. 전송 데이터 V1~V6 */
+#define CONFIG_BATCH_MAX 5U   /*!< LTE 모뎀을 한 번 켤 때 전송하는 최대 횟수 */
+#define CONFIG_RETRANSMISSIONS_MAX 8U /*!< AT 명령별 최대 전송 횟수. SENDING 재시도 간격이 2배씩 늘어나므로 작게 제한 */
+
+typedef struct
+{
+    uint32_t magic;           /*!< CONFIG_MAGIC */
+    uint16_t version;         /*!< CONFIG_VERSION */
+    uint16_t size;            /*!< sizeof(config_TypeDef) */
+    uint32_t sequence;        /*!< 저장할 때마다 증가. A, B 중 큰 쪽 사용 */
+    uint32_t wakeupInterval;  /*!< 센싱 주기. 단위 초 */
+    uint32_t sendingTimeout;  /*!< 링크 설정부터 서버 전송 완료까지 제한 시간. 단위 ms */
+    uint16_t sensingTimes;    /*!< 한 번에 전송하는 센싱 횟수. 1 ~ CONFIG_SENSING_MAX */
+    uint16_t uploadBatch;     /*!< LTE 모뎀을 한 번 켤 때 전송하는 횟수. 1 ~ CONFIG_BATCH_MAX */
+    uint8_t retransmissions;  /*!< AT 명령별 전송 횟수 (재전송 포함). 1 ~ CONFIG_RETRANSMISSIONS_MAX */
+    uint8_t reserved[3];      /*!< 0 */
+    char url[CONFIG_URL_MAX]; /*!< 서버 주소 (AT*WHTTP=0,POST,<url>) */
+    uint32_t crc;             /*!< 앞 항목의 CRC-32 */
+} config_TypeDef;             /*!< 플래시에 저장하는 설정. 크기는 8byte 배수 (더블워드 쓰기) */
+
+/* Extern functions ---------------------------------------------------------*/
+void Config_Init(void);                              /*!< 유효한 설정 선택 */
+const config_TypeDef *Config_Get(void);              /*!< 사용 중인 설정 */
+ErrorStatus Config_Save(const config_TypeDef *config); /*!< 설정 저장 */
+ErrorStatus Config_Parse(const char *text, config_TypeDef *parsed); /*!< 설정 명령 문자열 분석 */
+
+#endif /* CONFIG_H__ */
@@ -0,0 +1,43 @@
+/**
+  ******************************************************************************
+  * @file    crc.c
+  * @author  정두원
+  * @date    2020-12-24
+  * @brief   CRC 계산
+  * @details SRAM2 보관 영역(retain.c), 플래시 설정(config.c) 확인용. 하드웨어 CRC 는 쓰지 않음.
+  */
+
+#include "crc.h"
+
+/** @defgroup CRC CRC 계산
+  * @brief CRC-32 (IEEE 802.3)
+  * @{
+  */
+
+/**
+ * @brief CRC-32 (다항식 0xEDB88320, 4비트 테이블)
+ *
+ * @param data: 데이터
+ * @param size: 크기
+ * @return uint32_t: CRC
+ */
+uint32_t Crc_Calculate32(const void *data, size_t size)
+{
+    static const uint32_t table[16] = {
+        0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU, 0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+        0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU, 0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU};
+    const uint8_t *byte = (const uint8_t *)data;
+    uint32_t crc = 0xFFFFFFFFU;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= byte[i];
+        crc = (crc >> 4) ^ table[crc & 0x0FU];
+        crc = (crc >> 4) ^ table[crc & 0x0FU];
+    }
+    return ~crc;
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,10 @@
+#ifndef CRC_H__
+#define CRC_H__ 1
+
+#include <stddef.h>
+#include "main.h"
+
+/* Extern functions ---------------------------------------------------------*/
+uint32_t Crc_Calculate32(const void *data, size_t size); /*!< CRC-32 계산 */
+
+#endif /* CRC_H__ */
@@ -0,0 +1,210 @@
+/**
+  ******************************************************************************
+  * @file    energy.c
+  * @author  정두원
+  * @date    2020-12-16
+  * @brief   배터리 소모량 계산
+  * @details 전원 상태(MCU Run/Stop, LTE 모뎀 접속, 송신, 12V 전원, 스탠바이)마다 머문 시간에
+  *          하드웨어 리비전별 소모 전류를 곱해 전하량을 누적. 누적 전하량과 경과 시간은
+  *          RTC 백업 레지스터에 저장하여 스탠바이 후에도 이어서 계산하고, 배터리를 교체하면
+  *          (백업 도메인 초기화) 0 부터 다시 계산. 하루 평균 소모량과 예상 수명을 서버로 보고.
+  */
+
+#include <stdio.h>
+#include "energy.h"
+#include "backup.h"
+#include "rtc.h"
+
+/** @defgroup ENERGY 배터리 소모량 계산
+  * @brief 전원 상태별 전하량 누적 및 수명 예측
+  * @{
+  */
+
+#define ENERGY_PROFILE_COUNT 2U              /*!< 전류 프로파일이 있는 하드웨어 리비전 갯수 */
+#define ENERGY_NC_PER_MAH 3600000000.0f      /*!< 1 mAh = 3.6 C */
+#define ENERGY_SEC_PER_DAY 86400.0f
+
+#if ENERGY_HW_REVISION >= ENERGY_PROFILE_COUNT
+#error "ENERGY_HW_REVISION has no current profile"
+#endif
+
+/**
+ * @brief 하드웨어 리비전별 소모 전류. 전류계로 측정한 값으로 갱신.
+ *        {스탠바이, Stop 1, Run, LTE 모뎀, LTE 모뎀 송신, 12V, 배터리 용량}
+ */
+static const energyProfile_TypeDef energyProfiles[ENERGY_PROFILE_COUNT] = {
+    {30U, 15U, 4500U, 15000U, 180000U, 25000U, 19000U}, /* 리비전 0 */
+    {20U, 10U, 4000U, 12000U, 180000U, 20000U, 19000U}  /* 리비전 1 */
+};
+
+/* Private variables ---------------------------------------------------------*/
+static const energyProfile_TypeDef *profile = &energyProfiles[ENERGY_HW_REVISION];
+static uint64_t charge;    /*!< 누적 전하량. 단위 nC (uA x ms) */
+static uint32_t elapsed;   /*!< 지난 깨어남까지 누적 경과 시간. 단위 초 */
+static uint32_t wakeTick;  /*!< 이번에 깨어난 시각. HAL_GetTick() 기준 */
+static uint32_t lastTick;  /*!< 마지막으로 누적한 시각 */
+static uint32_t loads;     /*!< 켜져 있는 부하. ENERGY_LOAD_xxx */
+
+/* Private functions ---------------------------------------------------------*/
+static void accumulate(void);
+static uint32_t getCurrent(void);
+static float getElapsed(void);
+
+/**
+ * @brief 백업 레지스터의 누적 전하량, 경과 시간 불러오기. Timebase_Init() 이후 호출.
+ *
+ */
+void Energy_Init(void)
+{
+    charge = ((uint64_t)HAL_RTCEx_BKUPRead(&hrtc, BKP_CHARGE_HIGH) << 32) | HAL_RTCEx_BKUPRead(&hrtc, BKP_CHARGE_LOW);
+    elapsed = HAL_RTCEx_BKUPRead(&hrtc, BKP_ELAPSED);
+    loads = ENERGY_LOAD_MCU;
+    wakeTick = HAL_GetTick();
+    lastTick = wakeTick;
+}
+
+/**
+ * @brief 전원 상태 변경. 변경 전 상태로 지금까지의 전하량 누적. 사용자 Loop 에서만 호출.
+ *
+ * @param load: ENERGY_LOAD_xxx
+ * @param on: true 면 켜짐
+ */
+void Energy_SetLoad(uint32_t load, bool on)
+{
+    accumulate();
+    if (on)
+    {
+        loads |= load;
+    }
+    else
+    {
+        loads &= ~load;
+    }
+}
+
+/**
+ * @brief 깨어 있던 시간과 스탠바이 예정 시간을 반영하여 백업 레지스터에 저장. 스탠바이 진입 직전 호출.
+ * @note  RTC wake-up 타이머로 깨어나는 것으로 계산. 리셋, 사용자 버튼으로 일찍 깨어나면 약간 많게 계산됨.
+ *
+ * @param delaySec: 스탠바이 시간. 단위 초
+ */
+void Energy_EnterStandby(uint32_t delaySec)
+{
+    accumulate();
+    charge += (uint64_t)profile->standby * delaySec * 1000U;
+    elapsed += ((lastTick - wakeTick) + 500U) / 1000U + delaySec; /* 깨어 있던 시간은 반올림 */
+    wakeTick = lastTick;
+
+    HAL_RTCEx_BKUPWrite(&hrtc, BKP_CHARGE_LOW, (uint32_t)charge);
+    HAL_RTCEx_BKUPWrite(&hrtc, BKP_CHARGE_HIGH, (uint32_t)(charge >> 32));
+    HAL_RTCEx_BKUPWrite(&hrtc, BKP_ELAPSED, elapsed);
+}
+
+/**
+ * @brief 배터리 교체 후 하루 평균 소모량
+ *
+ * @return float: 단위 mAh/일. 경과 시간이 없으면 0
+ */
+float Energy_GetDailyCharge(void)
+{
+    float seconds;
+
+    accumulate();
+    seconds = getElapsed();
+    if (seconds < 1.0f)
+    {
+        return 0.0f;
+    }
+    return ((float)charge / ENERGY_NC_PER_MAH) * ENERGY_SEC_PER_DAY / seconds;
+}
+
+/**
+ * @brief 배터리 남은 용량을 하루 평균 소모량으로 나눈 예상 수명
+ *
+ * @return uint32_t: 단위 일. 소모량을 알 수 없으면 0
+ */
+uint32_t Energy_GetLifetime(void)
+{
+    float daily = Energy_GetDailyCharge();
+    float remaining = (float)profile->capacity - ((float)charge / ENERGY_NC_PER_MAH);
+
+    if ((daily <= 0.0f) || (remaining <= 0.0f))
+    {
+        return 0U;
+    }
+    return (uint32_t)(remaining / daily);
+}
+
+/**
+ * @brief 서버 전송 데이터에 붙일 문자열. \&Mahd=하루 평균 소모량 mAh\&Life=예상 수명 일
+ *
+ * @param buffer: 출력 버퍼
+ * @param size: 버퍼 크기
+ * @return int: 출력한 길이. 버퍼가 부족하면 잘린 길이
+ */
+int Energy_Print(char *buffer, size_t size)
+{
+    int length;
+
+    if (size == 0U)
+    {
+        return 0;
+    }
+
+    length = snprintf(buffer, size, "\\&Mahd=%.3f\\&Life=%lu", Energy_GetDailyCharge(), (unsigned long)Energy_GetLifetime());
+    if (length < 0)
+    {
+        return 0;
+    }
+    return ((size_t)length >= size) ? (int)(size - 1U) : length;
+}
+
+/**
+ * @brief 마지막 누적 이후 시간 동안 현재 전원 상태의 전하량 누적
+ *
+ */
+static void accumulate(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    charge += (uint64_t)getCurrent() * (now - lastTick);
+    lastTick = now;
+}
+
+/**
+ * @brief 현재 전원 상태의 소모 전류
+ *
+ * @return uint32_t: 단위 uA
+ */
+static uint32_t getCurrent(void)
+{
+    uint32_t current = ((loads & ENERGY_LOAD_MCU) != 0U) ? profile->run : profile->stop;
+
+    if ((loads & ENERGY_LOAD_MODEM) != 0U)
+    {
+        current += profile->modem;
+    }
+    if ((loads & ENERGY_LOAD_MODEM_TX) != 0U)
+    {
+        current += profile->modemTx;
+    }
+    if ((loads & ENERGY_LOAD_12V) != 0U)
+    {
+        current += profile->rail12V;
+    }
+    return current;
+}
+
+/**
+ * @brief 배터리 교체 후 경과 시간
+ *
+ * @return float: 단위 초
+ */
+static float getElapsed(void)
+{
+    return (float)elapsed + ((float)(lastTick - wakeTick) / 1000.0f);
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,34 @@
+#ifndef ENERGY_H__
+#define ENERGY_H__ 1
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "main.h"
+
+#define ENERGY_HW_REVISION 1U /*!< 하드웨어 리비전. energy.c 의 전류 프로파일 선택 */
+
+#define ENERGY_LOAD_MCU (1U << 0)      /*!< MCU Run, Sleep 모드. 꺼져 있으면 Stop 1 모드 */
+#define ENERGY_LOAD_MODEM (1U << 1)    /*!< LTE 모뎀 깨어 있음 (네트워크 접속) */
+#define ENERGY_LOAD_MODEM_TX (1U << 2) /*!< LTE 모뎀 송신 중 */
+#define ENERGY_LOAD_12V (1U << 3)      /*!< 외부 디바이스 12V 전원 */
+
+typedef struct
+{
+    uint32_t standby;  /*!< 스탠바이 모드 (RTC, LTE 모뎀 절전 포함). 단위 uA */
+    uint32_t stop;     /*!< MCU Stop 1 모드. 단위 uA */
+    uint32_t run;      /*!< MCU Run 모드 32MHz (주변장치, MAX3232 포함). 단위 uA */
+    uint32_t modem;    /*!< LTE 모뎀 네트워크 접속 상태 추가분. 단위 uA */
+    uint32_t modemTx;  /*!< LTE 모뎀 송신 추가분. 단위 uA */
+    uint32_t rail12V;  /*!< 12V 전원 (외부 디바이스 포함, 배터리 기준). 단위 uA */
+    uint32_t capacity; /*!< 배터리 용량. 단위 mAh */
+} energyProfile_TypeDef; /*!< 전원 상태별 배터리 소모 전류 */
+
+/* Extern functions ---------------------------------------------------------*/
+void Energy_Init(void);                         /*!< 백업 레지스터의 누적 전하량 불러오기 */
+void Energy_SetLoad(uint32_t load, bool on);    /*!< 전원 상태 변경 */
+void Energy_EnterStandby(uint32_t delaySec);    /*!< 스탠바이 시간 반영 및 저장 */
+float Energy_GetDailyCharge(void);              /*!< 하루 평균 소모량. 단위 mAh */
+uint32_t Energy_GetLifetime(void);              /*!< 예상 배터리 남은 수명. 단위 일 */
+int Energy_Print(char *buffer, size_t size);    /*!< 전송 데이터용 문자열 */
+
+#endif /* ENERGY_H__ */
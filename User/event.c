@@ -0,0 +1,70 @@
+/**
+  ******************************************************************************
+  * @file    event.c
+  * @author  정두원
+  * @date    2020-12-07
+  * @brief   사용자 Loop 이벤트
+  * @details 인터럽트에서 발생한 일을 비트로 모아 두고, 사용자 Loop 는 이벤트가
+  *          없으면 Sleep 또는 Stop 모드에 들어가 다음 인터럽트까지 대기.
+  */
+
+#include "event.h"
+#include "power.h"
+#include "timer.h"
+
+/** @defgroup EVENT 사용자 Loop 이벤트
+  * @brief 이벤트 알림 및 대기
+  * @{
+  */
+
+/* Private variables ---------------------------------------------------------*/
+static volatile uint32_t eventPending; /*!< 처리하지 않은 이벤트 */
+
+/**
+ * @brief 이벤트 발생 알림. 같은 이벤트가 처리 전에 여러 번 오면 한 번으로 처리됨.
+ *
+ * @param event: EVENT_xxx 조합
+ */
+void Event_Post(uint32_t event)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    eventPending |= event;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief 이벤트가 생길 때까지 저전력 대기. 사용자 Loop 에서만 호출.
+ * @note  인터럽트 금지 상태에서 이벤트를 확인하고 WFI 를 실행하므로 확인과 Sleep 사이에
+ *        발생한 인터럽트도 놓치지 않음 (대기 중인 인터럽트가 있으면 WFI 는 바로 깨어남).
+ *        대기 전 가장 가까운 타이머 만료 시각으로 알람을 설정하므로 그때까지 주기 인터럽트 없이 대기.
+ *        Sleep, Stop 모드 선택은 Power_Idle() 에서 결정.
+ *
+ * @return uint32_t: 발생한 이벤트. 반환 후 모두 처리한 것으로 간주
+ */
+uint32_t Event_Wait(void)
+{
+    uint32_t events;
+
+    __disable_irq();
+    if (eventPending == 0U)
+    {
+        Timer_ArmNext();
+    }
+    while (eventPending == 0U)
+    {
+        Power_Idle();
+        __enable_irq(); /* 깨운 인터럽트 처리 */
+        __disable_irq();
+    }
+    events = eventPending;
+    eventPending = 0U;
+    __enable_irq();
+
+    return events;
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,18 @@
+#ifndef EVENT_H__
+#define EVENT_H__ 1
+
+#include "main.h"
+
+#define EVENT_TICK (1UL << 0)     /*!< 타이머 만료 시각 도달. Timer_Process() 로 처리 */
+#define EVENT_UART1_RX (1UL << 1) /*!< LTE 모뎀 수신 (IDLE, DMA 절반/완료) */
+#define EVENT_UART2_RX (1UL << 2) /*!< DEBUG 포트 수신 */
+#define EVENT_UART_TX (1UL << 3)  /*!< UART DMA 송신 완료. 송신 버퍼 공간 생김 */
+#define EVENT_STATE (1UL << 4)    /*!< 운용모드 변경 */
+#define EVENT_ADC (1UL << 5)      /*!< ADC 변환 완료 */
+#define EVENT_MODEM (1UL << 6)    /*!< AT 명령 대기열에 추가. Modem_Process() 에서 전송 */
+
+/* Extern functions ---------------------------------------------------------*/
+void Event_Post(uint32_t event); /*!< 이벤트 발생 알림. 인터럽트에서 호출 가능 */
+uint32_t Event_Wait(void);       /*!< 이벤트가 생길 때까지 저전력 대기 후 발생한 이벤트 반환 */
+
+#endif /* EVENT_H__ */
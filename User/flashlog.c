@@ -0,0 +1,458 @@
+/**
+  ******************************************************************************
+  * @file    flashlog.c
+  * @author  정두원
+  * @date    2020-12-21
+  * @brief   센싱 값 플래시 로그
+  * @details 남는 내부 플래시 페이지(FLASHLOG_FIRST_PAGE 부터 FLASHLOG_PAGES 개)를 링으로 사용하는
+  *          추가 전용 로그. 모든 레코드는 64비트 더블워드 한 번의 쓰기이므로 쓰는 중 전원이
+  *          꺼져도 그 레코드만 CRC 검사로 버려짐. 페이지를 차례로 돌며 지우므로 지우기 횟수가 모든
+  *          페이지에 고르게 나뉨. 전송 완료는 레코드를 고치지 않고 완료 레코드를 추가하여 기록.
+  *
+  *          페이지 헤더: 페이지 순번(32) | FLASHLOG_MAGIC(32)
+  *          레코드: CRC-8(8) | 순번(24) | 종류(4) | DIN(4) | 기준 전압 코드(12) | 디바이스 코드(12)
+  *          완료 레코드의 순번은 전송하지 않은 첫 센싱 값의 순번
+  */
+
+#include "flashlog.h"
+#include "log.h"
+
+/** @defgroup FLASHLOG 센싱 값 플래시 로그
+  * @brief 마모 분산 추가 전용 로그
+  * @{
+  */
+
+#define FLASHLOG_MAGIC 0x474F4C46U          /*!< 페이지 헤더 유효 표시 "FLOG" */
+#define FLASHLOG_ERASED 0xFFFFFFFFFFFFFFFFU /*!< 지워진 더블워드 */
+#define RECORD_SAMPLE 0x1U                  /*!< 센싱 값 */
+#define RECORD_COMMIT 0x2U                  /*!< 전송 완료 */
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t headPage;     /*!< 쓰는 중인 페이지 */
+static uint16_t headIndex;   /*!< 쓰는 중인 페이지에서 다음에 쓸 레코드 위치 */
+static uint32_t headPageSeq; /*!< 쓰는 중인 페이지 순번 */
+static uint32_t nextSeq;     /*!< 다음 센싱 값 순번 */
+static uint32_t tailSeq;     /*!< 전송하지 않은 첫 센싱 값 순번 */
+
+/* Private functions ---------------------------------------------------------*/
+static ErrorStatus append(uint8_t type, uint32_t seq, uint32_t data);
+static ErrorStatus advancePage(void);
+static bool findFirstSample(uint8_t page, uint32_t *seq);
+static bool decode(uint64_t value, uint8_t *type, uint32_t *seq, uint32_t *data);
+static uint64_t encode(uint8_t type, uint32_t seq, uint32_t data);
+static uint8_t crc8(uint64_t value);
+static bool isPageValid(uint8_t page, uint32_t *pageSeq);
+static uint64_t readRecord(uint8_t page, uint16_t index);
+static ErrorStatus program(uint32_t address, uint64_t value);
+static ErrorStatus formatPage(uint8_t page, uint32_t pageSeq);
+
+/**
+ * @brief 로그 검색. 가장 최근 페이지에서 쓸 위치를, 완료 레코드에서 전송하지 않은 첫 센싱 값을 찾음.
+ *        유효한 페이지가 없으면(처음 사용) 첫 페이지 초기화.
+ *
+ */
+void FlashLog_Init(void)
+{
+    bool found = false;
+    bool sampleFound = false;
+    bool commitFound = false;
+    uint32_t oldestSeq = 0U;
+    uint32_t pageSeq;
+
+    for (uint8_t page = 0; page < FLASHLOG_PAGES; page++) /* 가장 최근 페이지 */
+    {
+        if (isPageValid(page, &pageSeq) && (!found || ((int32_t)(pageSeq - headPageSeq) > 0)))
+        {
+            headPage = page;
+            headPageSeq = pageSeq;
+            found = true;
+        }
+    }
+
+    nextSeq = 0U;
+    tailSeq = 0U;
+    headIndex = 0U;
+    if (!found)
+    {
+        headPage = 0U;
+        headPageSeq = 1U;
+        (void)formatPage(headPage, headPageSeq);
+        return;
+    }
+
+    for (uint8_t i = 1U; i <= FLASHLOG_PAGES; i++) /* 오래된 페이지부터. 마지막이 가장 최근 페이지 */
+    {
+        uint8_t page = (uint8_t)((headPage + i) % FLASHLOG_PAGES);
+
+        if (!isPageValid(page, &pageSeq))
+        {
+            continue;
+        }
+        for (uint16_t index = 0; index < FLASHLOG_RECORDS_PER_PAGE; index++)
+        {
+            uint64_t value = readRecord(page, index);
+            uint8_t type;
+            uint32_t seq;
+            uint32_t data;
+
+            if (value == FLASHLOG_ERASED) /* 차례로 쓰므로 이후는 빈 자리 */
+            {
+                break;
+            }
+            if (page == headPage)
+            {
+                headIndex = (uint16_t)(index + 1U); /* 덜 써진 레코드도 다시 쓸 수 없으므로 건너뜀 */
+            }
+            if (!decode(value, &type, &seq, &data))
+            {
+                continue;
+            }
+            if (type == RECORD_SAMPLE)
+            {
+                if (!sampleFound)
+                {
+                    oldestSeq = seq;
+                    sampleFound = true;
+                }
+                nextSeq = (seq + 1U) & FLASHLOG_SEQ_MASK;
+            }
+            else if (type == RECORD_COMMIT)
+            {
+                tailSeq = seq;
+                commitFound = true;
+            }
+        }
+    }
+
+    if (!sampleFound)
+    {
+        nextSeq = tailSeq;
+    }
+    else if (!commitFound || (((tailSeq - oldestSeq) & FLASHLOG_SEQ_MASK) > ((nextSeq - oldestSeq) & FLASHLOG_SEQ_MASK)))
+    {
+        tailSeq = oldestSeq; /* 완료 기록이 없거나 남은 가장 오래된 값보다 앞 */
+    }
+    LOG_INFO("flashlog: page %u record %u, %u pending", headPage, headIndex, FlashLog_GetPending());
+}
+
+/**
+ * @brief 센싱 값 추가. 페이지가 가득 차면 다음 페이지를 지우고 사용. 지운 페이지에 전송하지 않은
+ *        값이 있었으면 버려짐.
+ * @note  페이지를 지우는 동안(약 22ms) 플래시에서 코드를 읽지 못해 CPU 가 멈춤.
+ *
+ * @param sample: 센싱 값
+ * @return ErrorStatus: 쓰기 실패하면 ERROR
+ */
+ErrorStatus FlashLog_Append(const sample_TypeDef *sample)
+{
+    uint32_t data = (sample->device & 0x0FFFU) | ((uint32_t)(sample->reference & 0x0FFFU) << 12) | ((uint32_t)(sample->din & 0x0FU) << 24);
+
+    if (append(RECORD_SAMPLE, nextSeq, data) != SUCCESS)
+    {
+        return ERROR;
+    }
+    nextSeq = (nextSeq + 1U) & FLASHLOG_SEQ_MASK;
+    return SUCCESS;
+}
+
+/**
+ * @brief 전송하지 않은 센싱 값을 오래된 것부터 읽기
+ *
+ * @param samples: 읽은 값 저장
+ * @param max: 최대 갯수
+ * @param first: 첫 값의 순번 저장. NULL 가능
+ * @return uint16_t: 읽은 갯수
+ */
+uint16_t FlashLog_Read(sample_TypeDef *samples, uint16_t max, uint32_t *first)
+{
+    uint32_t pending = FlashLog_GetPending();
+    uint16_t count = 0U;
+
+    if (first != NULL)
+    {
+        *first = tailSeq;
+    }
+
+    for (uint8_t i = 1U; (i <= FLASHLOG_PAGES) && (count < max); i++)
+    {
+        uint8_t page = (uint8_t)((headPage + i) % FLASHLOG_PAGES);
+        uint32_t pageSeq;
+
+        if (!isPageValid(page, &pageSeq))
+        {
+            continue;
+        }
+        for (uint16_t index = 0; (index < FLASHLOG_RECORDS_PER_PAGE) && (count < max); index++)
+        {
+            uint64_t value = readRecord(page, index);
+            uint8_t type;
+            uint32_t seq;
+            uint32_t data;
+
+            if (value == FLASHLOG_ERASED)
+            {
+                break;
+            }
+            if (decode(value, &type, &seq, &data) && (type == RECORD_SAMPLE) &&
+                (((seq - tailSeq) & FLASHLOG_SEQ_MASK) < pending))
+            {
+                samples[count].device = (uint16_t)(data & 0x0FFFU);
+                samples[count].reference = (uint16_t)((data >> 12) & 0x0FFFU);
+                samples[count].din = (uint8_t)((data >> 24) & 0x0FU);
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 전송하지 않은 센싱 값 갯수
+ *
+ * @return uint32_t: 갯수
+ */
+uint32_t FlashLog_GetPending(void)
+{
+    return (nextSeq - tailSeq) & FLASHLOG_SEQ_MASK;
+}
+
+/**
+ * @brief 서버가 받은 센싱 값의 전송 완료 기록. 전송하는 동안 가득 차서 버려진 값이 있어도
+ *        전송한 범위 first ~ first + count - 1 까지만 완료.
+ *
+ * @param first: 전송한 첫 값의 순번. FlashLog_Read() 의 first
+ * @param count: 전송한 갯수. FlashLog_Read() 로 읽은 갯수
+ * @return ErrorStatus: 쓰기 실패하면 ERROR. 다음 부팅 시 다시 전송됨
+ */
+ErrorStatus FlashLog_Commit(uint32_t first, uint16_t count)
+{
+    uint32_t end = (first + count) & FLASHLOG_SEQ_MASK;
+    uint32_t advance = (end - tailSeq) & FLASHLOG_SEQ_MASK;
+
+    if ((advance == 0U) || (advance > FlashLog_GetPending())) /* 이미 완료했거나 모두 버려진 범위 */
+    {
+        return SUCCESS;
+    }
+    tailSeq = end;
+    return append(RECORD_COMMIT, tailSeq, 0U);
+}
+
+/**
+ * @brief 레코드 1개 쓰기. 페이지가 가득 차면 다음 페이지로 넘어감.
+ *
+ * @param type: RECORD_xxx
+ * @param seq: 순번
+ * @param data: 28비트 값
+ * @return ErrorStatus: 쓰기 실패하면 ERROR
+ */
+static ErrorStatus append(uint8_t type, uint32_t seq, uint32_t data)
+{
+    uint32_t address;
+
+    if ((headIndex >= FLASHLOG_RECORDS_PER_PAGE) && (advancePage() != SUCCESS))
+    {
+        return ERROR;
+    }
+
+    address = FLASHLOG_ADDRESS + (headPage * FLASH_PAGE_SIZE) + ((headIndex + 1U) * 8U);
+    headIndex++; /* 실패해도 일부 써졌을 수 있으므로 다음 자리 사용 */
+    return program(address, encode(type, seq, data));
+}
+
+/**
+ * @brief 다음 페이지를 지우고 쓰는 페이지로 사용. 지운 페이지에 있던 전송하지 않은 값은 버리고,
+ *        전송 완료 기록이 지워지지 않도록 새 페이지 처음에 다시 기록.
+ *
+ * @return ErrorStatus: 지우기, 쓰기 실패하면 ERROR
+ */
+static ErrorStatus advancePage(void)
+{
+    uint8_t next = (uint8_t)((headPage + 1U) % FLASHLOG_PAGES);
+    uint32_t oldestSeq;
+
+    if (formatPage(next, headPageSeq + 1U) != SUCCESS)
+    {
+        return ERROR;
+    }
+    headPage = next;
+    headPageSeq++;
+    headIndex = 0U;
+
+    oldestSeq = nextSeq; /* 남은 페이지에 값이 없으면 모두 지워짐 */
+    for (uint8_t i = 1U; i < FLASHLOG_PAGES; i++) /* 링을 아직 한 바퀴 돌지 않았으면 빈 페이지 다음이 가장 오래된 페이지 */
+    {
+        if (findFirstSample((uint8_t)((next + i) % FLASHLOG_PAGES), &oldestSeq))
+        {
+            break;
+        }
+    }
+    if (((oldestSeq - tailSeq) & FLASHLOG_SEQ_MASK) <= FlashLog_GetPending()) /* 전송하지 않은 값이 지워짐 */
+    {
+        if (oldestSeq != tailSeq)
+        {
+            LOG_WARN("flashlog: %u pending records dropped", (oldestSeq - tailSeq) & FLASHLOG_SEQ_MASK);
+            tailSeq = oldestSeq;
+        }
+    }
+
+    headIndex++;
+    return program(FLASHLOG_ADDRESS + (headPage * FLASH_PAGE_SIZE) + 8U, encode(RECORD_COMMIT, tailSeq, 0U));
+}
+
+/**
+ * @brief 페이지의 첫 센싱 값 순번. 가장 오래된 페이지에서 사용.
+ *
+ * @param page: 페이지
+ * @param seq: 순번 저장
+ * @return true: 센싱 값 있음
+ */
+static bool findFirstSample(uint8_t page, uint32_t *seq)
+{
+    uint32_t pageSeq;
+
+    if (!isPageValid(page, &pageSeq))
+    {
+        return false;
+    }
+    for (uint16_t index = 0; index < FLASHLOG_RECORDS_PER_PAGE; index++)
+    {
+        uint64_t value = readRecord(page, index);
+        uint8_t type;
+        uint32_t recordSeq;
+        uint32_t data;
+
+        if (value == FLASHLOG_ERASED)
+        {
+            break;
+        }
+        if (decode(value, &type, &recordSeq, &data) && (type == RECORD_SAMPLE))
+        {
+            *seq = recordSeq;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 레코드 해석
+ *
+ * @return true: CRC 가 맞는 레코드
+ */
+static bool decode(uint64_t value, uint8_t *type, uint32_t *seq, uint32_t *data)
+{
+    if ((uint8_t)(value >> 56) != crc8(value))
+    {
+        return false;
+    }
+    *data = (uint32_t)value & 0x0FFFFFFFU;
+    *type = (uint8_t)(((uint32_t)value >> 28) & 0x0FU);
+    *seq = (uint32_t)(value >> 32) & FLASHLOG_SEQ_MASK;
+    return true;
+}
+
+/**
+ * @brief 레코드 만들기
+ */
+static uint64_t encode(uint8_t type, uint32_t seq, uint32_t data)
+{
+    uint64_t value = (data & 0x0FFFFFFFU) | ((uint64_t)(type & 0x0FU) << 28) | ((uint64_t)(seq & FLASHLOG_SEQ_MASK) << 32);
+
+    return value | ((uint64_t)crc8(value) << 56);
+}
+
+/**
+ * @brief 하위 56비트의 CRC-8 (다항식 0x07)
+ */
+static uint8_t crc8(uint64_t value)
+{
+    uint8_t crc = 0U;
+
+    for (uint8_t i = 0; i < 7U; i++)
+    {
+        crc ^= (uint8_t)(value >> (i * 8U));
+        for (uint8_t bit = 0; bit < 8U; bit++)
+        {
+            crc = (uint8_t)(((crc & 0x80U) != 0U) ? (((uint32_t)crc << 1) ^ 0x07U) : ((uint32_t)crc << 1));
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief 페이지 헤더 확인
+ *
+ * @param page: 페이지
+ * @param pageSeq: 페이지 순번 저장
+ * @return true: 초기화된 페이지
+ */
+static bool isPageValid(uint8_t page, uint32_t *pageSeq)
+{
+    uint64_t header = *(volatile const uint64_t *)(FLASHLOG_ADDRESS + (page * FLASH_PAGE_SIZE));
+
+    *pageSeq = (uint32_t)(header >> 32);
+    return (uint32_t)header == FLASHLOG_MAGIC;
+}
+
+/**
+ * @brief 레코드 읽기. 덜 써진 더블워드는 ECC 에러 NMI 후 임의 값으로 읽혀 CRC 검사에서 버려짐.
+ */
+static uint64_t readRecord(uint8_t page, uint16_t index)
+{
+    return *(volatile const uint64_t *)(FLASHLOG_ADDRESS + (page * FLASH_PAGE_SIZE) + ((index + 1U) * 8U));
+}
+
+/**
+ * @brief 더블워드 쓰기
+ */
+static ErrorStatus program(uint32_t address, uint64_t value)
+{
+    HAL_StatusTypeDef status;
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+    status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, address, value);
+    HAL_FLASH_Lock();
+
+    if (status != HAL_OK)
+    {
+        LOG_ERROR("flashlog: program 0x%x failed", address);
+        return ERROR;
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 페이지 지우고 헤더 쓰기. 헤더를 쓰기 전에 전원이 꺼지면 빈 페이지로 남아 다음에 다시 사용.
+ *
+ * @param page: 페이지
+ * @param pageSeq: 페이지 순번
+ * @return ErrorStatus: 실패하면 ERROR
+ */
+static ErrorStatus formatPage(uint8_t page, uint32_t pageSeq)
+{
+    FLASH_EraseInitTypeDef erase = {0};
+    uint32_t pageError;
+    HAL_StatusTypeDef status;
+
+    erase.TypeErase = FLASH_TYPEERASE_PAGES;
+    erase.Banks = FLASH_BANK_1;
+    erase.Page = FLASHLOG_FIRST_PAGE + page;
+    erase.NbPages = 1U;
+
+    HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_ALL_ERRORS);
+    status = HAL_FLASHEx_Erase(&erase, &pageError);
+    HAL_FLASH_Lock();
+
+    if (status != HAL_OK)
+    {
+        LOG_ERROR("flashlog: erase page %u failed", page);
+        return ERROR;
+    }
+    return program(FLASHLOG_ADDRESS + (page * FLASH_PAGE_SIZE), ((uint64_t)pageSeq << 32) | FLASHLOG_MAGIC);
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,27 @@
+#ifndef FLASHLOG_H__
+#define FLASHLOG_H__ 1
+
+#include <stdbool.h>
+#include "main.h"
+
+#define FLASHLOG_FIRST_PAGE 48U /*!< 로그 첫 페이지 번호. 설정 페이지(CONFIG_PAGE_B) 바로 뒤 */
+#define FLASHLOG_PAGES 16U      /*!< 로그 페이지 갯수. 마지막 페이지까지 */
+#define FLASHLOG_ADDRESS (FLASH_BASE + (FLASHLOG_FIRST_PAGE * FLASH_PAGE_SIZE)) /*!< 0x08018000 */
+#define FLASHLOG_RECORDS_PER_PAGE ((FLASH_PAGE_SIZE / 8U) - 1U)                 /*!< 페이지 헤더 다음부터 레코드 */
+#define FLASHLOG_SEQ_MASK 0x00FFFFFFU                                           /*!< 레코드 순번 24비트 */
+
+typedef struct
+{
+    uint16_t device;    /*!< 외부 디바이스 ADC 코드. 12비트 */
+    uint16_t reference; /*!< 내부 기준 전압(VREFINT) ADC 코드. 12비트 */
+    uint8_t din;        /*!< [3:0] DIN3~0 */
+} sample_TypeDef;       /*!< 센싱 1회 값 */
+
+/* Extern functions ---------------------------------------------------------*/
+void FlashLog_Init(void);                                                 /*!< 로그 검색, 쓸 위치와 전송하지 않은 레코드 찾기 */
+ErrorStatus FlashLog_Append(const sample_TypeDef *sample);                /*!< 센싱 값 추가 */
+uint16_t FlashLog_Read(sample_TypeDef *samples, uint16_t max, uint32_t *first); /*!< 전송하지 않은 센싱 값 읽기 */
+uint32_t FlashLog_GetPending(void);                                       /*!< 전송하지 않은 센싱 값 갯수 */
+ErrorStatus FlashLog_Commit(uint32_t first, uint16_t count);              /*!< 전송 완료 기록 */
+
+#endif /* FLASHLOG_H__ */
@@ -0,0 +1,155 @@
+/**
+  ******************************************************************************
+  * @file    link.c
+  * @author  정두원
+  * @date    2020-12-03
+  * @brief   LTE 모뎀 UART 링크 설정
+  * @details 부팅 시 저장된 속도로 통신을 확인하고, AT+IPR 로 LINK_BAUD_TARGET 협상.
+  *          새 속도에서 응답이 없으면 이전 속도로 되돌리고, 저장된 속도로 응답이
+  *          없으면 기본 속도로 다시 확인. 확인된 속도는 백업 레지스터에 저장하여
+  *          스탠바이 후에도 유지. 협상 순서는 코루틴(pt.h)으로 작성.
+  */
+
+#include <stdio.h>
+#include "link.h"
+#include "modem.h"
+#include "uart.h"
+#include "backup.h"
+#include "log.h"
+#include "rtc.h"
+
+/** @defgroup LINK LTE 모뎀 링크 설정
+  * @brief 통신 속도 협상 및 흐름 제어
+  * @{
+  */
+
+#define LINK_MAGIC 0x4C000000U /*!< 백업 레지스터 유효 표시 */
+#define LINK_MAGIC_MASK 0xFF000000U
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t baudRate = LINK_BAUD_DEFAULT;     /*!< 현재 통신 속도 */
+static uint32_t lastBaudRate = LINK_BAUD_DEFAULT; /*!< 협상 전 통신 속도 */
+static bool ready;                                /*!< LTE 모뎀 응답 확인 */
+static modemWait_TypeDef wait;                    /*!< AT 명령 결과 */
+static char iprCommand[24];                       /*!< AT+IPR=<rate> */
+
+/* Private functions ---------------------------------------------------------*/
+static void setBaudRate(uint32_t rate);
+
+static const modemCommand_TypeDef probeCommand = {"AT\r\n", 0, AT_RSP_OK, 300, 2, NULL, NULL};
+static const modemCommand_TypeDef rateCommand = {iprCommand, 0, AT_RSP_OK, 500, 1, NULL, NULL};
+#if LINK_FLOW_CONTROL
+static const modemCommand_TypeDef flowCommand = {"AT+IFC=2,0\r\n", 0, AT_RSP_OK, 500, 1, NULL, NULL};
+#endif
+
+/**
+ * @brief 백업 레지스터에 저장된 통신 속도를 USART1 에 적용. Uart_Init() 이후 호출.
+ *
+ */
+void Link_Init(void)
+{
+    uint32_t stored = HAL_RTCEx_BKUPRead(&hrtc, BKP_LINK);
+
+    if ((stored & LINK_MAGIC_MASK) == LINK_MAGIC)
+    {
+        setBaudRate(stored & ~LINK_MAGIC_MASK);
+    }
+}
+
+/**
+ * @brief 통신 확인 및 속도 협상 코루틴. PT_SPAWN() 으로 실행하고 끝나면 Link_IsReady() 로 결과 확인.
+ *
+ * @param pt: 코루틴
+ */
+PT_THREAD(Link_Run(struct pt *pt))
+{
+    PT_BEGIN(pt);
+    ready = false;
+
+    MODEM_AWAIT(pt, &wait, &probeCommand); /* 저장된 속도로 확인 */
+    if ((wait.result != MODEM_RESULT_OK) && (baudRate != LINK_BAUD_DEFAULT)) /* 모뎀이 기본 속도로 돌아갔을 수 있음 */
+    {
+        LOG_WARN("link: no answer at %u", baudRate);
+        setBaudRate(LINK_BAUD_DEFAULT);
+        MODEM_AWAIT(pt, &wait, &probeCommand);
+    }
+    if (wait.result != MODEM_RESULT_OK)
+    {
+        LOG_ERROR("link: modem not responding");
+        PT_EXIT(pt);
+    }
+
+    if (baudRate != LINK_BAUD_TARGET)
+    {
+        snprintf(iprCommand, sizeof(iprCommand), "AT+IPR=%lu\r\n", (unsigned long)LINK_BAUD_TARGET);
+        MODEM_AWAIT(pt, &wait, &rateCommand);
+        if (wait.result == MODEM_RESULT_OK) /* 모뎀은 OK 응답 후 속도 변경. 실패하면 속도 변경 미지원, 현재 속도 유지 */
+        {
+            lastBaudRate = baudRate;
+            setBaudRate(LINK_BAUD_TARGET);
+            MODEM_AWAIT(pt, &wait, &probeCommand);
+            if (wait.result != MODEM_RESULT_OK)
+            {
+                LOG_WARN("link: no answer at %u, back to %u", baudRate, lastBaudRate);
+                setBaudRate(lastBaudRate);
+                MODEM_AWAIT(pt, &wait, &probeCommand);
+                if (wait.result != MODEM_RESULT_OK)
+                {
+                    LOG_ERROR("link: modem not responding");
+                    PT_EXIT(pt);
+                }
+            }
+        }
+    }
+
+    HAL_RTCEx_BKUPWrite(&hrtc, BKP_LINK, LINK_MAGIC | baudRate); /* 확인된 속도 저장 */
+    LOG_INFO("link: %u bps", baudRate);
+
+#if LINK_FLOW_CONTROL
+    MODEM_AWAIT(pt, &wait, &flowCommand);
+    if (wait.result == MODEM_RESULT_OK)
+    {
+        (void)Uart_SetBaudRate(&huart1, baudRate, UART_HWCONTROL_RTS);
+    }
+#endif
+
+    ready = true;
+    PT_END(pt);
+}
+
+/**
+ * @brief Link_Run() 결과
+ *
+ * @return true: LTE 모뎀과 통신 가능
+ */
+bool Link_IsReady(void)
+{
+    return ready;
+}
+
+/**
+ * @brief 현재 통신 속도
+ *
+ * @return uint32_t: bps
+ */
+uint32_t Link_GetBaudRate(void)
+{
+    return baudRate;
+}
+
+/**
+ * @brief USART1 통신 속도 변경
+ *
+ * @param rate: 통신 속도
+ */
+static void setBaudRate(uint32_t rate)
+{
+    if (Uart_SetBaudRate(&huart1, rate, UART_HWCONTROL_NONE) == SUCCESS)
+    {
+        baudRate = rate;
+    }
+}
+
+/**
+  * @}
+  */
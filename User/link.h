@@ -0,0 +1,21 @@
+#ifndef LINK_H__
+#define LINK_H__ 1
+
+#include <stdbool.h>
+#include "main.h"
+#include "pt.h"
+
+#define LINK_BAUD_DEFAULT 115200U /*!< LTE 모뎀 기본 통신 속도 */
+#define LINK_BAUD_TARGET 460800U  /*!< 협상할 통신 속도 */
+
+#ifndef LINK_FLOW_CONTROL
+#define LINK_FLOW_CONTROL 0 /*!< 1: RTS(PA12) 흐름 제어 사용. PA12 가 모뎀 RTS 에 연결된 보드에서만 사용 */
+#endif
+
+/* Extern functions ---------------------------------------------------------*/
+void Link_Init(void);                          /*!< 저장된 통신 속도 적용 */
+PT_THREAD(Link_Run(struct pt *pt));            /*!< 통신 확인 및 속도 협상 코루틴 */
+bool Link_IsReady(void);                       /*!< 통신 확인 결과 */
+uint32_t Link_GetBaudRate(void);               /*!< 현재 통신 속도 */
+
+#endif /* LINK_H__ */
@@ -0,0 +1,146 @@
+/**
+  ******************************************************************************
+  * @file    log.c
+  * @author  정두원
+  * @date    2020-11-30
+  * @brief   지연 전송 바이너리 로그
+  * @details 로그 호출 시에는 형식 ID, 시각, 인자만 RAM 링 버퍼에 기록하고,
+  *          사용자 Loop 가 한가할 때 UART2 DMA 로 전송. 문자열 변환은 PC 에서
+  *          Tools/logdecode.py 로 수행.
+  *
+  *          레코드: LOG_SYNC(1) | 레벨<<4 + 인자 갯수(1) | 형식 ID(2) | 시각 ms(4) | 인자(4 x n)
+  */
+
+#include <string.h>
+#include "log.h"
+#include "uart.h"
+#include "ring.h"
+
+/** @defgroup LOG 바이너리 로그
+  * @brief 로그 링 버퍼 및 전송
+  * @{
+  */
+
+typedef struct
+{
+    ring_TypeDef ring;         /*!< 생산자: 로그 호출 위치 (인터럽트 포함, 인터럽트 금지로 직렬화), 소비자: 사용자 Loop */
+    uint8_t buff[LOG_BUFFER_SIZE];
+    volatile uint16_t dropped; /*!< 버퍼가 가득 차 버린 로그 갯수 */
+} log_TypeDef;                 /*!< 로그 링 버퍼 구조체 */
+
+/* Private variables ---------------------------------------------------------*/
+static log_TypeDef logBuffer;
+
+/**
+ * @brief 로그 링 버퍼 초기화
+ *
+ */
+void Log_Init(void)
+{
+    Ring_Init(&logBuffer.ring, logBuffer.buff, LOG_BUFFER_SIZE);
+    logBuffer.dropped = 0U;
+}
+
+/**
+ * @brief 로그 1건을 링 버퍼에 기록. LOG_ERROR() 등의 매크로로 호출.
+ * @note  인터럽트에서도 호출되어 생산자가 여럿이므로 기록하는 동안 인터럽트 금지.
+ *
+ * @param id: 형식 문자열 ID (.logfmt 섹션 내 주소)
+ * @param meta: 레벨 << 4 | 인자 갯수
+ * @param args: 인자 배열
+ */
+void Log_Write(uint16_t id, uint8_t meta, const uint32_t *args)
+{
+    uint8_t record[8U + (LOG_ARGS_MAX * 4U)];
+    uint16_t length = (uint16_t)(8U + ((meta & 0x0FU) * 4U));
+    uint32_t tick = HAL_GetTick();
+    uint32_t primask;
+
+    record[0] = LOG_SYNC;
+    record[1] = meta;
+    memcpy(&record[2], &id, 2U);
+    memcpy(&record[4], &tick, 4U);
+    memcpy(&record[8], args, length - 8U);
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (Ring_Free(&logBuffer.ring) < length) /* 버퍼 부족 */
+    {
+        logBuffer.dropped++;
+    }
+    else
+    {
+        uint8_t *span;
+        uint16_t first = Ring_WriteSpan(&logBuffer.ring, &span);
+
+        if (first > length)
+        {
+            first = length;
+        }
+        memcpy(span, record, first);
+        memcpy(logBuffer.buff, &record[first], length - first); /* 링 버퍼 끝에서 나뉜 나머지 */
+        Ring_Commit(&logBuffer.ring, length);
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief 쌓인 로그를 UART2 송신 버퍼로 전달. 사용자 Loop 가 한가할 때 호출.
+ *
+ */
+void Log_Process(void)
+{
+    const uint8_t *data;
+    uint16_t length;
+
+    if (logBuffer.dropped != 0U)
+    {
+        uint32_t primask = __get_PRIMASK();
+        uint16_t dropped;
+
+        __disable_irq();
+        dropped = logBuffer.dropped;
+        logBuffer.dropped = 0U;
+        __set_PRIMASK(primask);
+        LOG_WARN("log: %u records dropped", dropped);
+    }
+
+    while ((length = Ring_ReadSpan(&logBuffer.ring, &data)) != 0U) /* 링 버퍼 끝에서 나뉘면 2번 */
+    {
+        uint16_t written = Uart_Write(&uart2Tx, data, length);
+
+        Ring_Consume(&logBuffer.ring, written);
+        if (written < length) /* 송신 버퍼가 가득 참 */
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief 쌓인 로그를 전송하지 않고 버림. DEBUG 포트를 다른 용도(패스스루)로 쓰기 전에 호출.
+ *
+ */
+void Log_Discard(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    Ring_Consume(&logBuffer.ring, Ring_Count(&logBuffer.ring));
+    __disable_irq();
+    logBuffer.dropped = 0U;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief 전송할 로그가 남았는지 확인
+ *
+ * @return true: 로그 없음
+ */
+bool Log_IsEmpty(void)
+{
+    return Ring_Count(&logBuffer.ring) == 0U;
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,73 @@
+#ifndef LOG_H__
+#define LOG_H__ 1
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "main.h"
+
+#define LOG_LEVEL_ERROR 0U /*!< 동작 실패 */
+#define LOG_LEVEL_WARN 1U  /*!< 재시도 등 복구 가능한 이상 */
+#define LOG_LEVEL_INFO 2U  /*!< 운용모드 변경 등 주요 동작 */
+#define LOG_LEVEL_DEBUG 3U /*!< 개발용 상세 정보 */
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO /*!< 이 레벨 이하의 로그만 컴파일. 빌드 옵션 -DLOG_LEVEL=n 으로 변경 */
+#endif
+
+#define LOG_BUFFER_SIZE 1024U /*!< 로그 링 버퍼 크기. 2의 거듭제곱 */
+#define LOG_ARGS_MAX 4U       /*!< 로그 1건의 최대 인자 갯수 */
+#define LOG_SYNC 0xA5U        /*!< 로그 레코드 시작 바이트 */
+
+/**
+ * @brief float 인자를 비트 그대로 전달. 형식 문자열에는 %f 사용.
+ */
+#define LOG_FLOAT(x) (((union { float f; uint32_t u; }){.f = (float)(x)}).u)
+
+/* 인자 갯수 (0 ~ LOG_ARGS_MAX) */
+#define LOG_NARGS(...) LOG_NARGS_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, n, ...) n
+
+/**
+ * @brief 형식 문자열은 타겟에 적재되지 않는 .logfmt 섹션에 두고 그 주소를 ID 로 기록.
+ *        인자는 uint32_t 로 변환되어 그대로 기록되며 문자열(%s) 인자는 지원하지 않음.
+ */
+#define LOG_WRITE(level, fmt, ...)                                                          \
+    do                                                                                      \
+    {                                                                                       \
+        static const char logFormat[] __attribute__((section(".logfmt"), used)) = fmt;     \
+        const uint32_t logArgs[LOG_ARGS_MAX + 1U] = {0U, ##__VA_ARGS__};                    \
+        Log_Write((uint16_t)(uintptr_t)logFormat, (uint8_t)(((level) << 4) | LOG_NARGS(__VA_ARGS__)), &logArgs[1]); \
+    } while (0)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(fmt, ...) LOG_WRITE(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(fmt, ...) LOG_WRITE(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(fmt, ...) LOG_WRITE(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(fmt, ...) LOG_WRITE(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(fmt, ...) do {} while (0)
+#endif
+
+/* Extern functions ---------------------------------------------------------*/
+void Log_Init(void);                                                /*!< 로그 링 버퍼 초기화 */
+void Log_Write(uint16_t id, uint8_t meta, const uint32_t *args);    /*!< 로그 1건 기록. 인터럽트에서도 호출 가능 */
+void Log_Process(void);                                             /*!< 로그를 UART2 송신 버퍼로 전달 */
+void Log_Discard(void);                                             /*!< 쌓인 로그 버림 */
+bool Log_IsEmpty(void);                                             /*!< 전송할 로그 없음 */
+
+#endif /* LOG_H__ */
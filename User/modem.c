@@ -0,0 +1,372 @@
+/**
+  ******************************************************************************
+  * @file    modem.c
+  * @author  정두원
+  * @date    2020-11-23
+  * @brief   LTE 모뎀 AT 명령 엔진
+  * @details 명령 대기열에 쌓인 AT 명령을 하나씩 DMA 로 전송하고, 명령마다 정해진
+  *          응답과 제한 시간으로 완료를 판단하여 콜백으로 결과를 알려줌.
+  */
+
+#include <string.h>
+#include "modem.h"
+#include "uart.h"
+#include "timer.h"
+#include "event.h"
+
+/** @defgroup MODEM AT 명령 엔진
+  * @brief LTE 모뎀 명령 대기열 및 응답 처리
+  * @{
+  */
+
+typedef struct
+{
+    const modemCommand_TypeDef *queue[MODEM_QUEUE_SIZE]; /*!< 명령 대기열 */
+    uint8_t head;                                        /*!< 다음에 꺼낼 위치 */
+    uint8_t tail;                                        /*!< 다음에 넣을 위치 */
+    const modemCommand_TypeDef *current;                 /*!< 처리 중인 명령 */
+    const modemCommand_TypeDef *resend;                  /*!< 송신 버퍼가 부족해 재전송하지 못한 명령 */
+    timer_TypeDef timer;                                 /*!< 응답 제한 시간 */
+    uint32_t startTick;                                  /*!< 현재 명령 전송 시각 */
+    uint32_t roundTrip;                                  /*!< 마지막으로 완료된 명령의 왕복 시간. 단위 ms */
+    const modemCommand_TypeDef *awaitCommand;            /*!< 코루틴이 기다리는 명령 */
+    modemWait_TypeDef *wait;                             /*!< 기다리는 명령의 결과 저장 위치 */
+    uint8_t retryCount;                                  /*!< 현재 명령의 재전송 횟수 */
+    bool expectReceived;                                 /*!< 기다리는 응답 수신 */
+    bool finalReceived;                                  /*!< 최종 응답 OK 수신 */
+    atResponse_TypeDef response;                         /*!< 수신된 응답 */
+    atResponse_TypeDef urc[MODEM_URC_SIZE];              /*!< 처리 중인 명령이 없을 때 받은 응답. 응답만 기다리는 명령에 전달 */
+    uint8_t urcHead;                                     /*!< 가장 오래된 보관 응답 */
+    uint8_t urcCount;                                    /*!< 보관 응답 갯수 */
+} modem_TypeDef;                                         /*!< AT 명령 엔진 상태 */
+
+/* Private variables ---------------------------------------------------------*/
+static modem_TypeDef modem;
+
+/* Private functions ---------------------------------------------------------*/
+static ErrorStatus startCommand(const modemCommand_TypeDef *command);
+static void handleResponse(const atResponse_TypeDef *response);
+static void keepUnsolicited(const atResponse_TypeDef *response);
+static void replayUnsolicited(void);
+static void completeCommand(modemResult result);
+static void onResponseTimeout(timer_TypeDef *timer);
+
+/**
+ * @brief AT 명령 엔진 초기화
+ *
+ */
+void Modem_Init(void)
+{
+    memset(&modem, 0, sizeof(modem));
+    Timer_Init(&modem.timer, onResponseTimeout);
+}
+
+/**
+ * @brief 사용자 Loop 에서 호출. 응답 분석, 다음 명령 전송. 응답 제한 시간은 타이머 콜백에서 처리.
+ *
+ */
+void Modem_Process(void)
+{
+    uartLine_TypeDef line;
+    atResponse_TypeDef response;
+
+    while (getLineFromBuffer(&uart1Buffer, &line) == SUCCESS) /* LTE 모뎀의 수신 데이터를 줄 단위로 분석 */
+    {
+        AT_ParseLine(&line, &response);
+        handleResponse(&response);
+    }
+
+    if ((modem.current == NULL) && (modem.resend != NULL)) /* 재전송 대기 중인 명령 */
+    {
+        if (startCommand(modem.resend) == SUCCESS)
+        {
+            modem.resend = NULL;
+        }
+    }
+    else if ((modem.current == NULL) && (modem.head != modem.tail)) /* 대기 중인 명령 전송 */
+    {
+        if (startCommand(modem.queue[modem.head]) == SUCCESS)
+        {
+            modem.head = (modem.head + 1U) & (MODEM_QUEUE_SIZE - 1U);
+        }
+    }
+}
+
+/**
+ * @brief 명령 대기열에 추가. 전송은 Modem_Process() 에서 앞 명령이 끝난 후 수행.
+ *
+ * @param command: 추가할 명령. 완료 콜백까지 유지되어야 함
+ * @return ErrorStatus: 대기열이 가득 차면 ERROR
+ */
+ErrorStatus Modem_Send(const modemCommand_TypeDef *command)
+{
+    uint8_t next = (modem.tail + 1U) & (MODEM_QUEUE_SIZE - 1U);
+
+    if (next == modem.head)
+    {
+        return ERROR;
+    }
+
+    modem.queue[modem.tail] = command;
+    modem.tail = next;
+    Event_Post(EVENT_MODEM); /* 대기 중이던 Loop 를 깨워 전송 */
+    return SUCCESS;
+}
+
+/**
+ * @brief 명령 대기열에 추가하고 완료 시 결과를 wait 에 저장. 코루틴에서 MODEM_AWAIT() 으로 사용.
+ *        한 번에 하나의 명령만 기다릴 수 있음.
+ *
+ * @param command: 추가할 명령
+ * @param wait: 결과 저장 위치. 대기열이 가득 차면 바로 MODEM_RESULT_ERROR 로 완료
+ */
+void Modem_Await(const modemCommand_TypeDef *command, modemWait_TypeDef *wait)
+{
+    wait->done = false;
+    wait->response.type = AT_RSP_NONE;
+    if (Modem_Send(command) != SUCCESS)
+    {
+        wait->result = MODEM_RESULT_ERROR;
+        wait->done = true;
+        return;
+    }
+    modem.awaitCommand = command;
+    modem.wait = wait;
+}
+
+/**
+ * @brief 대기 중인 명령 모두 취소. 처리 중인 명령은 완료까지 진행.
+ *        기다리던 명령이 취소되면 MODEM_RESULT_ERROR 로 완료.
+ *
+ */
+void Modem_Flush(void)
+{
+    modem.head = modem.tail;
+    if ((modem.wait != NULL) && (modem.awaitCommand != modem.current) && (modem.awaitCommand != modem.resend))
+    {
+        modem.wait->result = MODEM_RESULT_ERROR;
+        modem.wait->done = true;
+        modem.wait = NULL;
+    }
+}
+
+/**
+ * @brief 처리 중인 명령과 대기 중인 명령 모두 취소. 취소된 명령의 콜백은 호출하지 않음.
+ *
+ */
+void Modem_Abort(void)
+{
+    Timer_Stop(&modem.timer);
+    modem.head = modem.tail;
+    modem.current = NULL;
+    modem.resend = NULL;
+    modem.retryCount = 0U;
+    modem.wait = NULL;
+    modem.urcCount = 0U;
+}
+
+/**
+ * @brief 처리 중이거나 대기 중인 명령이 없는지 확인
+ *
+ * @return true: 명령 없음
+ */
+bool Modem_IsIdle(void)
+{
+    return (modem.current == NULL) && (modem.resend == NULL) && (modem.head == modem.tail);
+}
+
+/**
+ * @brief 전송한 명령의 응답만 기다리는 남은 시간. 이 시간 동안은 응답 수신 외에 할 일이 없음.
+ *
+ * @return uint32_t: 응답 제한 시간까지 남은 시간. 단위 ms. 처리 중인 명령이 없거나 전송할 명령이 있으면 0
+ */
+uint32_t Modem_GetWaitTime(void)
+{
+    if ((modem.current == NULL) || (modem.resend != NULL) || !Uart_IsTxIdle(&uart1Tx))
+    {
+        return 0U;
+    }
+
+    return Timer_GetRemaining(&modem.timer);
+}
+
+/**
+ * @brief 마지막으로 완료된 명령의 왕복 시간. 재전송했으면 마지막 전송부터 잰 시간. 완료 콜백에서 호출.
+ *
+ * @return uint32_t: 전송부터 완료까지 시간. 단위 ms
+ */
+uint32_t Modem_GetRoundTrip(void)
+{
+    return modem.roundTrip;
+}
+
+/**
+ * @brief 명령 전송 시작
+ *
+ * @param command: 전송할 명령
+ * @return ErrorStatus: 송신 버퍼가 부족하면 ERROR
+ */
+static ErrorStatus startCommand(const modemCommand_TypeDef *command)
+{
+    if (command->command != NULL)
+    {
+        uint16_t length = (command->length != 0U) ? command->length : (uint16_t)strlen(command->command);
+
+        if (Uart_GetTxFree(&uart1Tx) < length) /* 명령이 나뉘어 전송되지 않도록 한 번에 씀 */
+        {
+            return ERROR;
+        }
+        (void)Uart_Write(&uart1Tx, (const uint8_t *)command->command, length);
+        modem.urcCount = 0U; /* 보관 응답은 앞 명령의 것 */
+    }
+
+    modem.current = command;
+    modem.startTick = HAL_GetTick();
+    (void)Timer_Start(&modem.timer, command->timeout, false);
+    modem.expectReceived = false;
+    modem.finalReceived = (command->command == NULL); /* 응답만 기다리는 명령은 OK 불필요 */
+    modem.response.type = AT_RSP_NONE;
+    if (command->command == NULL) /* 앞 명령의 OK 와 같이 받은 URC 로 바로 완료될 수 있음 */
+    {
+        replayUnsolicited();
+    }
+    return SUCCESS;
+}
+
+/**
+ * @brief 분석된 응답 한 줄 처리
+ * @note  정보 응답(+CPIN 등)은 OK 까지 받아야 완료하여 다음 명령이 앞 명령의 OK 를 받지 않게 함.
+ *        OK 뒤에 오는 URC(*WHTTPR 등)는 해당 응답을 받으면 바로 완료.
+ *
+ * @param response: 분석된 응답
+ */
+static void handleResponse(const atResponse_TypeDef *response)
+{
+    if (modem.current == NULL) /* 기다리는 명령이 없는 URC 는 다음에 응답만 기다리는 명령을 위해 보관 */
+    {
+        keepUnsolicited(response);
+        return;
+    }
+
+    if (AT_IsErrorResult(response))
+    {
+        modem.response = *response;
+        completeCommand(MODEM_RESULT_ERROR);
+    }
+    else if (response->type == AT_RSP_OK)
+    {
+        modem.finalReceived = true;
+        if ((modem.current->expect == AT_RSP_OK) || modem.expectReceived)
+        {
+            if (modem.current->expect == AT_RSP_OK)
+            {
+                modem.response = *response;
+            }
+            completeCommand(MODEM_RESULT_OK);
+        }
+    }
+    else if ((response->type == modem.current->expect) &&
+             ((modem.current->accept == NULL) || modem.current->accept(response)))
+    {
+        modem.response = *response;
+        modem.expectReceived = true;
+        if (modem.finalReceived)
+        {
+            completeCommand(MODEM_RESULT_OK);
+        }
+    }
+}
+
+/**
+ * @brief 처리 중인 명령이 없을 때 받은 응답 보관. 최종 응답과 분류되지 않은 줄은 제외.
+ *        가득 차면 가장 오래된 응답을 버림.
+ *
+ * @param response: 분석된 응답
+ */
+static void keepUnsolicited(const atResponse_TypeDef *response)
+{
+    if ((response->type == AT_RSP_NONE) || (response->type == AT_RSP_UNKNOWN) || (response->type == AT_RSP_OK) ||
+        AT_IsErrorResult(response))
+    {
+        return;
+    }
+
+    if (modem.urcCount == MODEM_URC_SIZE)
+    {
+        modem.urcHead = (modem.urcHead + 1U) & (MODEM_URC_SIZE - 1U);
+        modem.urcCount--;
+    }
+    modem.urc[(modem.urcHead + modem.urcCount) & (MODEM_URC_SIZE - 1U)] = *response;
+    modem.urcCount++;
+}
+
+/**
+ * @brief 보관한 응답을 받은 순서대로 응답만 기다리는 명령에 전달. 완료되면 남은 응답은 그대로 보관.
+ *
+ */
+static void replayUnsolicited(void)
+{
+    const modemCommand_TypeDef *command = modem.current;
+
+    while ((modem.urcCount != 0U) && (modem.current == command))
+    {
+        atResponse_TypeDef response = modem.urc[modem.urcHead];
+
+        modem.urcHead = (modem.urcHead + 1U) & (MODEM_URC_SIZE - 1U);
+        modem.urcCount--;
+        handleResponse(&response);
+    }
+}
+
+/**
+ * @brief 처리 중인 명령 완료. 실패 시 재전송 횟수가 남아 있으면 다시 전송.
+ *
+ * @param result: 처리 결과
+ */
+static void completeCommand(modemResult result)
+{
+    const modemCommand_TypeDef *command = modem.current;
+
+    Timer_Stop(&modem.timer);
+    modem.current = NULL;
+    if ((result != MODEM_RESULT_OK) && (modem.retryCount < command->retry))
+    {
+        modem.retryCount++;
+        if (startCommand(command) != SUCCESS) /* 송신 버퍼가 부족하면 다음 Modem_Process() 에서 재전송 */
+        {
+            modem.resend = command;
+        }
+        return;
+    }
+
+    modem.retryCount = 0U;
+    modem.roundTrip = HAL_GetTick() - modem.startTick;
+    if ((modem.wait != NULL) && (command == modem.awaitCommand)) /* 코루틴은 다음 Loop 에서 결과 확인 */
+    {
+        modem.wait->result = result;
+        modem.wait->response = modem.response;
+        modem.wait->done = true;
+        modem.wait = NULL;
+    }
+    if (command->callback != NULL)
+    {
+        command->callback(command, result, &modem.response);
+    }
+}
+
+/**
+ * @brief 응답 제한 시간 타이머 만료 콜백
+ *
+ * @param timer: 응답 제한 시간 타이머
+ */
+static void onResponseTimeout(timer_TypeDef *timer)
+{
+    if (modem.current != NULL)
+    {
+        completeCommand(MODEM_RESULT_TIMEOUT);
+    }
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,81 @@
+#ifndef MODEM_H__
+#define MODEM_H__ 1
+
+#include <stdbool.h>
+#include "main.h"
+#include "atparser.h"
+#include "pt.h"
+
+#define MODEM_QUEUE_SIZE 16U /*!< 대기 가능한 명령 갯수. 2의 거듭제곱 */
+#define MODEM_URC_SIZE 4U    /*!< 처리 중인 명령이 없을 때 받은 응답을 보관하는 갯수. 2의 거듭제곱 */
+
+typedef enum
+{
+    MODEM_RESULT_OK = 0, /*!< 기다리던 응답 수신 */
+    MODEM_RESULT_ERROR,  /*!< ERROR, +CME ERROR 수신 */
+    MODEM_RESULT_TIMEOUT /*!< 제한 시간 안에 응답 없음 */
+} modemResult;           /*!< AT 명령 처리 결과 */
+
+typedef struct modemCommand modemCommand_TypeDef;
+
+/**
+ * @brief AT 명령 완료 콜백. Modem_Process() 에서 호출됨.
+ *
+ * @param command: 완료된 명령
+ * @param result: 처리 결과
+ * @param response: 기다리던 응답. 수신되지 않았으면 type 이 AT_RSP_NONE
+ */
+typedef void (*modemCallback_TypeDef)(const modemCommand_TypeDef *command, modemResult result, const atResponse_TypeDef *response);
+
+/**
+ * @brief 기다리는 응답의 내용 확인. false 를 반환하면 그 응답은 무시하고 계속 기다림.
+ *
+ * @param response: 기다리는 종류의 응답
+ * @return true: 완료로 처리
+ */
+typedef bool (*modemAccept_TypeDef)(const atResponse_TypeDef *response);
+
+struct modemCommand
+{
+    const char *command;            /*!< 전송할 명령. 완료 전까지 유지되어야 함. NULL 이면 전송 없이 응답만 기다림 */
+    uint16_t length;                /*!< 명령 길이. 0 이면 strlen() 사용 */
+    atResponseType expect;          /*!< 기다리는 응답. OK 가 아니면 OK 와 해당 응답을 모두 받아야 완료 */
+    uint32_t timeout;               /*!< 응답 제한 시간. 단위 ms */
+    uint8_t retry;                  /*!< 에러, 타임아웃 시 재전송 횟수 */
+    modemAccept_TypeDef accept;     /*!< 응답 내용 확인. NULL 이면 종류만 확인 */
+    modemCallback_TypeDef callback; /*!< 완료 콜백. NULL 가능 */
+};                                  /*!< AT 명령 */
+
+typedef struct
+{
+    volatile bool done;          /*!< 명령 완료 */
+    modemResult result;          /*!< 처리 결과 */
+    atResponse_TypeDef response; /*!< 기다리던 응답. 수신되지 않았으면 type 이 AT_RSP_NONE */
+} modemWait_TypeDef;             /*!< 코루틴에서 기다리는 명령의 결과 */
+
+/**
+ * @brief 코루틴에서 명령을 보내고 완료까지 대기. 결과는 wait 에 저장.
+ *
+ * @param pt: 코루틴
+ * @param wait: 결과 저장. 코루틴이 끝날 때까지 유지되어야 함 (static)
+ * @param command: 전송할 명령
+ */
+#define MODEM_AWAIT(pt, wait, command)     \
+    do                                     \
+    {                                      \
+        Modem_Await((command), (wait));    \
+        PT_WAIT_UNTIL((pt), (wait)->done); \
+    } while (0)
+
+/* Extern functions ---------------------------------------------------------*/
+void Modem_Init(void);                                      /*!< AT 명령 엔진 초기화 */
+void Modem_Process(void);                                   /*!< 응답 분석, 다음 명령 전송 */
+ErrorStatus Modem_Send(const modemCommand_TypeDef *command); /*!< 명령 대기열에 추가 */
+void Modem_Await(const modemCommand_TypeDef *command, modemWait_TypeDef *wait); /*!< 명령 대기열에 추가하고 완료 시 결과 저장 */
+void Modem_Flush(void);                                     /*!< 대기 중인 명령 모두 취소 */
+void Modem_Abort(void);                                     /*!< 처리 중인 명령까지 모두 취소 */
+bool Modem_IsIdle(void);                                    /*!< 처리 중인 명령 없음 */
+uint32_t Modem_GetWaitTime(void);                           /*!< 응답만 기다리는 남은 시간 */
+uint32_t Modem_GetRoundTrip(void);                          /*!< 마지막으로 완료된 명령의 왕복 시간 */
+
+#endif /* MODEM_H__ */
@@ -0,0 +1,378 @@
+/**
+  ******************************************************************************
+  * @file    pack.c
+  * @author  정두원
+  * @date    2020-12-22
+  * @brief   백업 레지스터 센싱 값 압축 저장
+  * @details 센싱 값을 RTC 백업 레지스터에 비트 단위로 이어 붙여 저장. 첫 값은 ADC 코드 그대로,
+  *          다음 값부터는 직전 값과의 차이만 저장. 전압은 주기 사이에 거의 변하지 않으므로 센싱
+  *          1회가 평균 13비트 정도로 백업 레지스터 23개에 50회 이상 저장됨. 전송할 때나 가득 차면
+  *          플래시 로그로 옮김.
+  *
+  *          BKP_PACK: PACK_MAGIC(8) | 센싱 횟수(8) | 사용한 비트 수(16)
+  *          첫 값: 디바이스 코드(12) 기준 전압 코드(12) DIN(4)
+  *          다음 값: 디바이스 차이, 기준 전압 차이, DIN 순서
+  *            차이: 종류(2) + 값. 0: 같음, 1: 4비트, 2: 8비트 (지그재그 부호), 3: 코드(12) 그대로
+  *            DIN: 0(1) 같음, 1(1) + DIN(4)
+  */
+
+#include "pack.h"
+#include "backup.h"
+#include "log.h"
+#include "rtc.h"
+
+/** @defgroup PACK 백업 레지스터 센싱 값 압축
+  * @brief 차이 부호화한 센싱 값을 백업 레지스터에 저장
+  * @{
+  */
+
+#define PACK_MAGIC 0x5A000000U /*!< 백업 레지스터 유효 표시 */
+#define PACK_MAGIC_MASK 0xFF000000U
+#define PACK_FIRST_BITS 28U    /*!< 첫 값 크기 */
+
+/**
+ * @brief 센싱 값을 담는 백업 레지스터. 비트 순서대로
+ */
+static const uint32_t packRegisters[PACK_REGISTERS] = {
+    RTC_BKP_DR1, RTC_BKP_DR2, RTC_BKP_DR3, RTC_BKP_DR4, RTC_BKP_DR5, RTC_BKP_DR6, RTC_BKP_DR7,
+    RTC_BKP_DR10, RTC_BKP_DR11, RTC_BKP_DR12, RTC_BKP_DR13, RTC_BKP_DR14, RTC_BKP_DR15, RTC_BKP_DR16, RTC_BKP_DR17,
+    RTC_BKP_DR20, RTC_BKP_DR21, RTC_BKP_DR22, RTC_BKP_DR23, RTC_BKP_DR24, RTC_BKP_DR25, RTC_BKP_DR26, RTC_BKP_DR27};
+
+/* Private variables ---------------------------------------------------------*/
+static uint16_t count;       /*!< 저장된 센싱 횟수 */
+static uint16_t length;      /*!< 사용한 비트 수 */
+static sample_TypeDef last;  /*!< 마지막 센싱 값. 다음 값의 차이 기준 */
+
+/* Private functions ---------------------------------------------------------*/
+static void save(void);
+static bool decodeNext(uint16_t *position, sample_TypeDef *sample, bool first);
+static uint8_t getDeltaClass(uint16_t previous, uint16_t current);
+static void putDelta(uint16_t *position, uint16_t previous, uint16_t current);
+static bool getDelta(uint16_t *position, uint16_t previous, uint16_t *current);
+static void putBits(uint16_t position, uint32_t value, uint8_t width);
+static uint32_t getBits(uint16_t position, uint8_t width);
+
+static const uint8_t deltaBits[4] = {0U, 4U, 8U, 12U}; /*!< 차이 종류별 값 크기 */
+
+/**
+ * @brief 백업 레지스터의 센싱 값 확인. 끝까지 풀어서 마지막 값을 찾고, 헤더가 맞지 않으면 지움.
+ *
+ */
+void Pack_Init(void)
+{
+    uint32_t header = HAL_RTCEx_BKUPRead(&hrtc, BKP_PACK);
+    uint16_t position = 0U;
+
+    count = (uint16_t)((header >> 16) & 0xFFU);
+    length = (uint16_t)header;
+    if (((header & PACK_MAGIC_MASK) != PACK_MAGIC) || (length > PACK_CAPACITY))
+    {
+        Pack_Clear();
+        return;
+    }
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        if (!decodeNext(&position, &last, i == 0U) || (position > length))
+        {
+            LOG_WARN("pack: corrupted after %u samples", i);
+            Pack_Clear();
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 센싱 값 추가
+ *
+ * @param sample: 센싱 값
+ * @return ErrorStatus: 공간이 없으면 ERROR. 플래시 로그로 옮기고 다시 추가
+ */
+ErrorStatus Pack_Push(const sample_TypeDef *sample)
+{
+    uint16_t position = length;
+    uint16_t bits = PACK_FIRST_BITS;
+
+    if (count != 0U)
+    {
+        bits = (uint16_t)(4U + deltaBits[getDeltaClass(last.device, sample->device)] +
+                          deltaBits[getDeltaClass(last.reference, sample->reference)] +
+                          ((sample->din == last.din) ? 1U : 5U));
+    }
+    if ((count >= PACK_COUNT_MAX) || ((length + bits) > PACK_CAPACITY))
+    {
+        return ERROR;
+    }
+
+    if (count == 0U)
+    {
+        putBits(position, sample->device & 0x0FFFU, 12U);
+        putBits(position + 12U, sample->reference & 0x0FFFU, 12U);
+        putBits(position + 24U, sample->din & 0x0FU, 4U);
+        position += PACK_FIRST_BITS;
+    }
+    else
+    {
+        putDelta(&position, last.device, sample->device & 0x0FFFU);
+        putDelta(&position, last.reference, sample->reference & 0x0FFFU);
+        if (sample->din == last.din)
+        {
+            putBits(position++, 0U, 1U);
+        }
+        else
+        {
+            putBits(position, 0x01U | ((uint32_t)(sample->din & 0x0FU) << 1), 5U);
+            position += 5U;
+        }
+    }
+
+    last.device = sample->device & 0x0FFFU;
+    last.reference = sample->reference & 0x0FFFU;
+    last.din = sample->din & 0x0FU;
+    length = position;
+    count++;
+    save(); /* 헤더를 마지막에 써서 쓰는 중 리셋되면 추가하지 않은 것으로 됨 */
+    return SUCCESS;
+}
+
+/**
+ * @brief 센싱 값을 저장한 순서대로 읽기. 차이 부호화이므로 처음부터 풀면서 first 번째부터 저장.
+ *
+ * @param samples: 읽은 값 저장
+ * @param first: 읽기 시작할 순서
+ * @param max: 최대 갯수
+ * @return uint16_t: 읽은 갯수
+ */
+uint16_t Pack_Read(sample_TypeDef *samples, uint16_t first, uint16_t max)
+{
+    sample_TypeDef sample = {0};
+    uint16_t position = 0U;
+    uint16_t read = 0U;
+
+    for (uint16_t i = 0; (i < count) && (read < max); i++)
+    {
+        if (!decodeNext(&position, &sample, i == 0U))
+        {
+            break;
+        }
+        if (i >= first)
+        {
+            samples[read++] = sample;
+        }
+    }
+    return read;
+}
+
+/**
+ * @brief 저장된 센싱 횟수
+ *
+ * @return uint16_t: 횟수
+ */
+uint16_t Pack_GetCount(void)
+{
+    return count;
+}
+
+/**
+ * @brief 모두 지우기. 플래시 로그로 옮긴 후 호출.
+ *
+ */
+void Pack_Clear(void)
+{
+    count = 0U;
+    length = 0U;
+    last.device = 0U;
+    last.reference = 0U;
+    last.din = 0U;
+    save();
+}
+
+/**
+ * @brief 헤더 저장
+ *
+ */
+static void save(void)
+{
+    HAL_RTCEx_BKUPWrite(&hrtc, BKP_PACK, PACK_MAGIC | ((uint32_t)count << 16) | length);
+}
+
+/**
+ * @brief 다음 센싱 값 풀기
+ *
+ * @param position: 읽을 비트 위치. 다음 값 위치로 변경
+ * @param sample: 직전 값. 읽은 값으로 변경
+ * @param first: 첫 값
+ * @return true: 성공. 공간을 넘으면 false
+ */
+static bool decodeNext(uint16_t *position, sample_TypeDef *sample, bool first)
+{
+    if (first)
+    {
+        if ((*position + PACK_FIRST_BITS) > PACK_CAPACITY)
+        {
+            return false;
+        }
+        sample->device = (uint16_t)getBits(*position, 12U);
+        sample->reference = (uint16_t)getBits(*position + 12U, 12U);
+        sample->din = (uint8_t)getBits(*position + 24U, 4U);
+        *position += PACK_FIRST_BITS;
+        return true;
+    }
+
+    if (!getDelta(position, sample->device, &sample->device) ||
+        !getDelta(position, sample->reference, &sample->reference) ||
+        ((*position + 1U) > PACK_CAPACITY))
+    {
+        return false;
+    }
+    if (getBits((*position)++, 1U) != 0U)
+    {
+        if ((*position + 4U) > PACK_CAPACITY)
+        {
+            return false;
+        }
+        sample->din = (uint8_t)getBits(*position, 4U);
+        *position += 4U;
+    }
+    return true;
+}
+
+/**
+ * @brief 차이 종류. 차이는 지그재그 부호로 0, -1, 1, -2 ... 를 0, 1, 2, 3 ... 으로 바꿈
+ *
+ * @return uint8_t: 0 같음, 1 4비트, 2 8비트, 3 코드 그대로
+ */
+static uint8_t getDeltaClass(uint16_t previous, uint16_t current)
+{
+    int32_t delta = (int32_t)(current & 0x0FFFU) - (int32_t)previous;
+    uint32_t zigzag = (delta >= 0) ? ((uint32_t)delta << 1) : (((uint32_t)(-delta) << 1) - 1U);
+
+    if (zigzag == 0U)
+    {
+        return 0U;
+    }
+    if (zigzag < 16U)
+    {
+        return 1U;
+    }
+    if (zigzag < 256U)
+    {
+        return 2U;
+    }
+    return 3U;
+}
+
+/**
+ * @brief 차이 저장
+ */
+static void putDelta(uint16_t *position, uint16_t previous, uint16_t current)
+{
+    uint8_t type = getDeltaClass(previous, current);
+    int32_t delta = (int32_t)current - (int32_t)previous;
+    uint32_t value = (delta >= 0) ? ((uint32_t)delta << 1) : (((uint32_t)(-delta) << 1) - 1U);
+
+    if (type == 3U)
+    {
+        value = current;
+    }
+    putBits(*position, type, 2U);
+    *position += 2U;
+    if (type != 0U)
+    {
+        putBits(*position, value, deltaBits[type]);
+        *position += deltaBits[type];
+    }
+}
+
+/**
+ * @brief 차이 읽기
+ *
+ * @return true: 성공. 공간을 넘으면 false
+ */
+static bool getDelta(uint16_t *position, uint16_t previous, uint16_t *current)
+{
+    uint8_t type;
+    uint32_t value;
+
+    if ((*position + 2U) > PACK_CAPACITY)
+    {
+        return false;
+    }
+    type = (uint8_t)getBits(*position, 2U);
+    *position += 2U;
+    if ((*position + deltaBits[type]) > PACK_CAPACITY)
+    {
+        return false;
+    }
+    value = getBits(*position, deltaBits[type]);
+    *position += deltaBits[type];
+
+    if (type == 3U)
+    {
+        *current = (uint16_t)value;
+    }
+    else
+    {
+        int32_t delta = ((value & 1U) != 0U) ? -(int32_t)((value + 1U) >> 1) : (int32_t)(value >> 1);
+        *current = (uint16_t)(((int32_t)previous + delta) & 0x0FFF);
+    }
+    return true;
+}
+
+/**
+ * @brief 비트 쓰기. 레지스터 경계를 넘으면 나눠 씀. 최대 32비트
+ *
+ * @param position: 비트 위치
+ * @param value: 값
+ * @param width: 비트 수
+ */
+static void putBits(uint16_t position, uint32_t value, uint8_t width)
+{
+    while (width > 0U)
+    {
+        uint8_t index = (uint8_t)(position / 32U);
+        uint8_t offset = (uint8_t)(position % 32U);
+        uint8_t bits = ((32U - offset) < width) ? (uint8_t)(32U - offset) : width;
+        uint32_t mask = ((bits == 32U) ? 0xFFFFFFFFU : ((1U << bits) - 1U)) << offset;
+        uint32_t word = HAL_RTCEx_BKUPRead(&hrtc, packRegisters[index]);
+
+        word = (word & ~mask) | ((value << offset) & mask);
+        HAL_RTCEx_BKUPWrite(&hrtc, packRegisters[index], word);
+
+        value = (bits == 32U) ? 0U : (value >> bits);
+        position += bits;
+        width -= bits;
+    }
+}
+
+/**
+ * @brief 비트 읽기. 최대 32비트
+ *
+ * @param position: 비트 위치
+ * @param width: 비트 수
+ * @return uint32_t: 값
+ */
+static uint32_t getBits(uint16_t position, uint8_t width)
+{
+    uint32_t value = 0U;
+    uint8_t shift = 0U;
+
+    while (width > 0U)
+    {
+        uint8_t index = (uint8_t)(position / 32U);
+        uint8_t offset = (uint8_t)(position % 32U);
+        uint8_t bits = ((32U - offset) < width) ? (uint8_t)(32U - offset) : width;
+        uint32_t mask = (bits == 32U) ? 0xFFFFFFFFU : ((1U << bits) - 1U);
+
+        value |= ((HAL_RTCEx_BKUPRead(&hrtc, packRegisters[index]) >> offset) & mask) << shift;
+
+        shift += bits;
+        position += bits;
+        width -= bits;
+    }
+    return value;
+}
+
+/**
+  * @}
+  */
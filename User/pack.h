@@ -0,0 +1,19 @@
+#ifndef PACK_H__
+#define PACK_H__ 1
+
+#include <stdbool.h>
+#include "main.h"
+#include "flashlog.h"
+
+#define PACK_REGISTERS 23U                 /*!< 센싱 값을 담는 백업 레지스터 갯수. backup.h */
+#define PACK_CAPACITY (PACK_REGISTERS * 32U) /*!< 센싱 값 저장 공간. 단위 비트 */
+#define PACK_COUNT_MAX 255U                /*!< 최대 센싱 횟수 */
+
+/* Extern functions ---------------------------------------------------------*/
+void Pack_Init(void);                                                      /*!< 백업 레지스터의 센싱 값 확인 */
+ErrorStatus Pack_Push(const sample_TypeDef *sample);                       /*!< 센싱 값 추가 */
+uint16_t Pack_Read(sample_TypeDef *samples, uint16_t first, uint16_t max); /*!< 센싱 값 읽기 */
+uint16_t Pack_GetCount(void);                                              /*!< 저장된 센싱 횟수 */
+void Pack_Clear(void);                                                     /*!< 모두 지우기 */
+
+#endif /* PACK_H__ */
@@ -0,0 +1,63 @@
+/**
+  ******************************************************************************
+  * @file    power.c
+  * @author  정두원
+  * @date    2020-12-08
+  * @brief   저전력 대기
+  * @details LTE 모뎀 응답만 기다리는 동안 Stop 1 모드로 대기. LTE 모뎀 UART 의 시작 비트
+  *          또는 timebase.c 의 LPTIM1 알람(응답 제한 시간 등)으로 깨어남. 시간 기준이 LPTIM1
+  *          이므로 Stop 모드 후 보정이 필요 없음.
+  *          USART1/2 는 Stop 2 모드에서 깨울 수 없으므로 Stop 1 모드 사용.
+  */
+
+#include "power.h"
+#include "uart.h"
+#include "modem.h"
+#include "timebase.h"
+#include "energy.h"
+
+/** @defgroup POWER 저전력 대기
+  * @brief Sleep, Stop 모드 선택
+  * @{
+  */
+
+/* Private variables ---------------------------------------------------------*/
+static volatile bool stopEnabled = false; /*!< Stop 모드 허용 */
+
+/**
+ * @brief Stop 모드 허용. 허용해도 LTE 모뎀 응답만 기다릴 때만 Stop 모드로 들어감.
+ *
+ * @param enable: true 면 허용
+ */
+void Power_EnableStop(bool enable)
+{
+    stopEnabled = enable;
+}
+
+/**
+ * @brief 처리할 이벤트가 없을 때 Event_Wait() 에서 인터럽트 금지 상태로 호출.
+ *        LTE 모뎀 응답만 기다리고 송신할 데이터가 없으면 Stop 1 모드, 아니면 Sleep 모드.
+ *
+ */
+void Power_Idle(void)
+{
+    if (stopEnabled &&
+        Uart_IsTxIdle(&uart1Tx) && Uart_IsTxIdle(&uart2Tx) && /* Stop 모드에서는 DMA 송신도 멈춤 */
+        (Modem_GetWaitTime() != 0U) &&
+        (Timebase_GetTimeToAlarm() >= POWER_STOP_MIN_TIME) &&
+        (Uart_EnterStopMode() == SUCCESS))
+    {
+        Energy_SetLoad(ENERGY_LOAD_MCU, false);
+        HAL_PWREx_EnterSTOP1Mode(PWR_STOPENTRY_WFI); /* 깨어나면 MSI 32MHz 로 바로 재개 */
+        Energy_SetLoad(ENERGY_LOAD_MCU, true);
+        Uart_ExitStopMode();
+    }
+    else
+    {
+        __WFI();
+    }
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,13 @@
+#ifndef POWER_H__
+#define POWER_H__ 1
+
+#include <stdbool.h>
+#include "main.h"
+
+#define POWER_STOP_MIN_TIME 5U /*!< 다음 알람까지 이보다 짧으면 Sleep 모드. 단위: ms */
+
+/* Extern functions ---------------------------------------------------------*/
+void Power_EnableStop(bool enable); /*!< LTE 모뎀 응답 대기 중 Stop 모드 허용 */
+void Power_Idle(void);              /*!< 처리할 이벤트가 없을 때 Sleep 또는 Stop 모드 진입 */
+
+#endif /* POWER_H__ */
@@ -0,0 +1,225 @@
+/**
+  ******************************************************************************
+  * @file    profile.c
+  * @author  정두원
+  * @date    2020-12-14
+  * @brief   운용모드, AT 명령 소요 시간 측정
+  * @details 운용모드마다 머문 시간(LPTIM1 시간 기준, Stop 중에도 증가)과 CPU 동작 시간
+  *          (DWT 사이클 카운터, Sleep, Stop 중에는 멈춤)을, AT 명령마다 전송부터 완료까지
+  *          왕복 시간을 기록하여 최소, 최대, 마지막 값으로 집계.
+  *          통계는 SRAM2 보관 영역(retain.c)에 두어 스탠바이 후에도 유지하고 서버 전송 시 보고.
+  */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "profile.h"
+#include "retain.h"
+
+/** @defgroup PROFILE 소요 시간 측정
+  * @brief 운용모드 진입 시각, AT 명령 왕복 시간 통계
+  * @{
+  */
+
+#define PROFILE_NONE 0xFFU        /*!< 측정 중인 운용모드 없음 */
+
+typedef struct
+{
+    profileStat_TypeDef stage[PROFILE_STAGE_MAX];     /*!< 운용모드에 머문 시간. 단위 ms */
+    uint32_t active[PROFILE_STAGE_MAX];               /*!< 운용모드의 마지막 CPU 동작 시간. 단위 us */
+    profileStat_TypeDef command[PROFILE_COMMAND_MAX]; /*!< AT 명령 왕복 시간. 단위 ms */
+} profile_TypeDef;                                    /*!< 스탠바이 후에도 유지되는 통계 */
+
+/* Private variables ---------------------------------------------------------*/
+static profile_TypeDef profile RETAINED;    /*!< SRAM2 보관 영역 RETAIN_PROFILE */
+static uint8_t currentStage = PROFILE_NONE; /*!< 측정 중인 운용모드 */
+static uint32_t enterTick;                  /*!< 운용모드 진입 시각. HAL_GetTick() 기준 */
+static uint32_t enterCycle;                 /*!< 운용모드 진입 시 DWT 사이클 카운터 */
+
+/* Private functions ---------------------------------------------------------*/
+static void update(profileStat_TypeDef *stat, uint32_t value);
+static size_t append(char *buffer, size_t size, size_t length, const char *format, ...);
+
+/**
+ * @brief DWT 사이클 카운터 시작. 보관된 통계가 유효하지 않으면(전원 인가 후 처음) 초기화.
+ *
+ */
+void Profile_Init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0U;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    if (!Retain_Attach(RETAIN_PROFILE, &profile, sizeof(profile)))
+    {
+        Profile_Clear();
+    }
+    currentStage = PROFILE_NONE;
+}
+
+/**
+ * @brief 운용모드 진입 시각 기록. 앞 운용모드에 머문 시간과 CPU 동작 시간 집계.
+ *
+ * @param stage: 진입한 운용모드
+ */
+void Profile_StageEnter(uint8_t stage)
+{
+    uint32_t tick = HAL_GetTick();
+    uint32_t cycle = DWT->CYCCNT;
+
+    if (currentStage < PROFILE_STAGE_MAX)
+    {
+        update(&profile.stage[currentStage], tick - enterTick);
+        profile.active[currentStage] = (cycle - enterCycle) / (SystemCoreClock / 1000000U);
+    }
+
+    currentStage = stage;
+    enterTick = tick;
+    enterCycle = cycle;
+}
+
+/**
+ * @brief AT 명령 왕복 시간 기록
+ *
+ * @param index: 명령 번호
+ * @param roundTrip: 전송부터 완료까지 시간. 단위 ms
+ */
+void Profile_Command(uint8_t index, uint32_t roundTrip)
+{
+    if (index < PROFILE_COMMAND_MAX)
+    {
+        update(&profile.command[index], roundTrip);
+    }
+}
+
+/**
+ * @brief 운용모드에 머문 시간 통계
+ *
+ * @param stage: 운용모드
+ * @return const profileStat_TypeDef*: 단위 ms. 범위 밖이면 NULL
+ */
+const profileStat_TypeDef *Profile_GetStage(uint8_t stage)
+{
+    return (stage < PROFILE_STAGE_MAX) ? &profile.stage[stage] : NULL;
+}
+
+/**
+ * @brief AT 명령 왕복 시간 통계
+ *
+ * @param index: 명령 번호
+ * @return const profileStat_TypeDef*: 단위 ms. 범위 밖이면 NULL
+ */
+const profileStat_TypeDef *Profile_GetCommand(uint8_t index)
+{
+    return (index < PROFILE_COMMAND_MAX) ? &profile.command[index] : NULL;
+}
+
+/**
+ * @brief 서버 전송 데이터에 붙일 통계 문자열. 기록이 있는 항목만 출력.
+ *        \&Lat=운용모드:최소/최대/마지막/CPU us,...\&Rtt=명령 번호:최소/최대/마지막,...
+ *
+ * @param buffer: 출력 버퍼
+ * @param size: 버퍼 크기
+ * @return int: 출력한 길이. 버퍼가 부족하면 잘린 길이
+ */
+int Profile_Print(char *buffer, size_t size)
+{
+    size_t length;
+    const char *separator = "";
+
+    if (size == 0U)
+    {
+        return 0;
+    }
+
+    length = append(buffer, size, 0U, "\\&Lat=");
+    for (uint8_t i = 0; i < PROFILE_STAGE_MAX; i++)
+    {
+        const profileStat_TypeDef *stat = &profile.stage[i];
+
+        if (stat->count != 0U)
+        {
+            length = append(buffer, size, length, "%s%u:%lu/%lu/%lu/%lu", separator, i,
+                            (unsigned long)stat->min, (unsigned long)stat->max, (unsigned long)stat->last,
+                            (unsigned long)profile.active[i]);
+            separator = ",";
+        }
+    }
+
+    length = append(buffer, size, length, "\\&Rtt=");
+    separator = "";
+    for (uint8_t i = 0; i < PROFILE_COMMAND_MAX; i++)
+    {
+        const profileStat_TypeDef *stat = &profile.command[i];
+
+        if (stat->count != 0U)
+        {
+            length = append(buffer, size, length, "%s%u:%lu/%lu/%lu", separator, i,
+                            (unsigned long)stat->min, (unsigned long)stat->max, (unsigned long)stat->last);
+            separator = ",";
+        }
+    }
+
+    return (int)length;
+}
+
+/**
+ * @brief 통계 초기화. 측정 중인 운용모드는 계속 측정.
+ *
+ */
+void Profile_Clear(void)
+{
+    memset(&profile, 0, sizeof(profile));
+}
+
+/**
+ * @brief 통계에 측정값 추가
+ *
+ * @param stat: 통계
+ * @param value: 측정값
+ */
+static void update(profileStat_TypeDef *stat, uint32_t value)
+{
+    if ((stat->count == 0U) || (value < stat->min))
+    {
+        stat->min = value;
+    }
+    if ((stat->count == 0U) || (value > stat->max))
+    {
+        stat->max = value;
+    }
+    stat->last = value;
+    if (stat->count != 0xFFFFFFFFU)
+    {
+        stat->count++;
+    }
+}
+
+/**
+ * @brief 버퍼 뒤에 형식 문자열 추가
+ *
+ * @param buffer: 출력 버퍼
+ * @param size: 버퍼 크기
+ * @param length: 지금까지 출력한 길이
+ * @param format: 형식 문자열
+ * @return size_t: 출력한 전체 길이. 버퍼가 부족하면 size - 1
+ */
+static size_t append(char *buffer, size_t size, size_t length, const char *format, ...)
+{
+    va_list args;
+    int n;
+
+    va_start(args, format);
+    n = vsnprintf(&buffer[length], size - length, format, args);
+    va_end(args);
+
+    if ((n < 0) || ((size_t)n >= (size - length)))
+    {
+        return size - 1U;
+    }
+    return length + (size_t)n;
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,27 @@
+#ifndef PROFILE_H__
+#define PROFILE_H__ 1
+
+#include <stddef.h>
+#include "main.h"
+
+#define PROFILE_STAGE_MAX 12U   /*!< 기록 가능한 운용모드 갯수 */
+#define PROFILE_COMMAND_MAX 12U /*!< 기록 가능한 AT 명령 갯수 (서버 전송 순서 번호) */
+
+typedef struct
+{
+    uint32_t min;   /*!< 최소값 */
+    uint32_t max;   /*!< 최대값 */
+    uint32_t last;  /*!< 마지막 값 */
+    uint32_t count; /*!< 기록 횟수. 0 이면 기록 없음 */
+} profileStat_TypeDef; /*!< 측정값 통계 */
+
+/* Extern functions ---------------------------------------------------------*/
+void Profile_Init(void);                                       /*!< DWT 사이클 카운터 시작, 보관된 통계 확인 */
+void Profile_StageEnter(uint8_t stage);                        /*!< 운용모드 진입 시각 기록. 앞 운용모드 시간 집계 */
+void Profile_Command(uint8_t index, uint32_t roundTrip);       /*!< AT 명령 왕복 시간 기록 */
+const profileStat_TypeDef *Profile_GetStage(uint8_t stage);    /*!< 운용모드에 머문 시간 통계 */
+const profileStat_TypeDef *Profile_GetCommand(uint8_t index);  /*!< AT 명령 왕복 시간 통계 */
+int Profile_Print(char *buffer, size_t size);                  /*!< 전송 데이터용 통계 문자열 */
+void Profile_Clear(void);                                      /*!< 통계 초기화 */
+
+#endif /* PROFILE_H__ */
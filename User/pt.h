@@ -0,0 +1,124 @@
+#ifndef PT_H__
+#define PT_H__ 1
+
+/**
+ * @brief 스택 없는 코루틴 (protothread). 대기 지점에서 함수가 반환하고, 다시 호출되면
+ *        switch 의 case 로 대기 지점에 바로 돌아옴. 코루틴마다 2byte 만 사용.
+ * @note  대기 지점(PT_WAIT_xxx, PT_SPAWN, PT_YIELD)을 지나면 지역 변수 값이 유지되지 않으므로
+ *        static 변수 사용. 코루틴 본문에 switch 문을 쓸 수 없음.
+ *
+ *        static PT_THREAD(example(struct pt *pt))
+ *        {
+ *            PT_BEGIN(pt);
+ *            PT_WAIT_UNTIL(pt, ready);
+ *            PT_END(pt);
+ *        }
+ */
+
+#define PT_WAITING 0 /*!< 대기 중 */
+#define PT_YIELDED 1 /*!< 양보 */
+#define PT_EXITED 2  /*!< PT_EXIT() 로 종료 */
+#define PT_ENDED 3   /*!< PT_END() 까지 실행 */
+
+struct pt
+{
+    unsigned short lc; /*!< 다시 시작할 위치 (__LINE__). 0 이면 처음 */
+};
+
+/**
+ * @brief 코루틴 함수 선언. 반환값은 PT_WAITING ~ PT_ENDED
+ */
+#define PT_THREAD(declaration) char declaration
+
+/**
+ * @brief 처음부터 다시 실행하도록 초기화
+ */
+#define PT_INIT(pt) ((pt)->lc = 0U)
+
+/**
+ * @brief 코루틴 본문 시작
+ */
+#define PT_BEGIN(pt)              \
+    {                             \
+        char ptYieldFlag = 1;     \
+        (void)ptYieldFlag;        \
+        switch ((pt)->lc)         \
+        {                         \
+        case 0:
+
+/**
+ * @brief 코루틴 본문 끝. 다시 호출하면 처음부터 실행.
+ */
+#define PT_END(pt)       \
+        }                \
+        PT_INIT(pt);     \
+        return PT_ENDED; \
+    }
+
+/**
+ * @brief 조건이 참이 될 때까지 대기
+ */
+#define PT_WAIT_UNTIL(pt, condition) \
+    do                               \
+    {                                \
+        (pt)->lc = __LINE__;         \
+        case __LINE__:               \
+        if (!(condition))            \
+        {                            \
+            return PT_WAITING;       \
+        }                            \
+    } while (0)
+
+/**
+ * @brief 조건이 거짓이 될 때까지 대기
+ */
+#define PT_WAIT_WHILE(pt, condition) PT_WAIT_UNTIL((pt), !(condition))
+
+/**
+ * @brief 자식 코루틴이 끝날 때까지 대기
+ */
+#define PT_WAIT_THREAD(pt, thread) PT_WAIT_WHILE((pt), PT_SCHEDULE(thread))
+
+/**
+ * @brief 자식 코루틴을 처음부터 실행하고 끝날 때까지 대기
+ */
+#define PT_SPAWN(pt, child, thread)     \
+    do                                  \
+    {                                   \
+        PT_INIT(child);                 \
+        PT_WAIT_THREAD((pt), (thread)); \
+    } while (0)
+
+/**
+ * @brief 한 번 양보하고 다음 호출에서 계속
+ */
+#define PT_YIELD(pt)             \
+    do                           \
+    {                            \
+        ptYieldFlag = 0;         \
+        (pt)->lc = __LINE__;     \
+        case __LINE__:           \
+        if (ptYieldFlag == 0)    \
+        {                        \
+            return PT_YIELDED;   \
+        }                        \
+    } while (0)
+
+/**
+ * @brief 코루틴 종료. 다시 호출하면 처음부터 실행.
+ */
+#define PT_EXIT(pt)          \
+    do                       \
+    {                        \
+        PT_INIT(pt);         \
+        return PT_EXITED;    \
+    } while (0)
+
+/**
+ * @brief 코루틴 1회 실행
+ *
+ * @return 0 이 아니면 아직 끝나지 않음
+ */
+#define PT_SCHEDULE(thread) ((thread) < PT_EXITED)
+
+#endif /* PT_H__ */
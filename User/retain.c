@@ -0,0 +1,107 @@
+/**
+  ******************************************************************************
+  * @file    retain.c
+  * @author  정두원
+  * @date    2020-12-23
+  * @brief   SRAM2 보관 영역 관리
+  * @details 스탠바이 모드에서 SRAM2 를 유지하면 백업 레지스터(128byte)보다 큰 상태를 깨어남 사이에
+  *          보관할 수 있음. 모듈마다 보관 영역을 연결하고, 스탠바이 직전에 영역별 크기와 CRC-32 를
+  *          헤더에 기록. 깨어나서 헤더 버전, 영역 크기, CRC 가 모두 맞는 영역만 이어서 사용하고
+  *          나머지는 0 으로 초기화하므로, 전원 인가, 동작 중 리셋, 구조 변경 후에도 잘못된 값을 쓰지 않음.
+  */
+
+#include <string.h>
+#include "retain.h"
+#include "crc.h"
+#include "log.h"
+
+/** @defgroup RETAIN SRAM2 보관 영역
+  * @brief 버전, CRC 로 확인하는 스탠바이 유지 영역
+  * @{
+  */
+
+#define RETAIN_MAGIC 0x52544E00U /*!< 헤더 유효 표시. 하위 바이트는 RETAIN_VERSION */
+
+typedef struct
+{
+    void *data;    /*!< 연결된 변수 */
+    uint32_t size; /*!< 크기. 단위 byte */
+    uint32_t crc;  /*!< 스탠바이 직전 CRC-32 */
+} retainEntry_TypeDef;
+
+typedef struct
+{
+    uint32_t magic;                                  /*!< RETAIN_MAGIC | RETAIN_VERSION 이면 유효 */
+    retainEntry_TypeDef entry[RETAIN_REGION_COUNT]; /*!< 영역별 기록 */
+} retainHeader_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static retainHeader_TypeDef header RETAINED; /*!< 영역 기록 */
+static bool headerValid;                     /*!< 깨어났을 때 헤더 유효 */
+
+/**
+ * @brief 보관 영역 헤더 확인. 각 모듈 초기화(Retain_Attach) 전에 호출.
+ *
+ */
+void Retain_Init(void)
+{
+    headerValid = (RETAIN_SRAM2 != 0U) && (header.magic == (RETAIN_MAGIC | RETAIN_VERSION));
+    if (!headerValid)
+    {
+        memset(&header, 0, sizeof(header));
+        header.magic = RETAIN_MAGIC | RETAIN_VERSION;
+    }
+    for (uint8_t i = 0; i < RETAIN_REGION_COUNT; i++) /* 이번에 연결한 영역만 스탠바이 전에 기록 */
+    {
+        header.entry[i].data = NULL;
+    }
+}
+
+/**
+ * @brief 보관 영역 연결. 스탠바이 전에 기록한 크기와 CRC 가 맞으면 내용을 그대로 두고,
+ *        맞지 않으면 0 으로 초기화.
+ *
+ * @param region: 영역
+ * @param data: RETAINED 로 선언한 변수
+ * @param size: 크기
+ * @return true: 스탠바이 전 내용 유지됨. false 이면 모듈에서 기본 값 설정
+ */
+bool Retain_Attach(retainRegion region, void *data, size_t size)
+{
+    retainEntry_TypeDef *entry = &header.entry[region];
+    bool valid = headerValid && (entry->size == size) && (entry->crc == Crc_Calculate32(data, size));
+
+    if (!valid)
+    {
+        LOG_INFO("retain: region %u initialized", region);
+        memset(data, 0, size);
+    }
+    entry->data = data;
+    entry->size = (uint32_t)size;
+    entry->crc = 0U; /* 스탠바이 전에 다시 기록. 동작 중 리셋되면 버려짐 */
+    return valid;
+}
+
+/**
+ * @brief 스탠바이 직전에 호출. 연결된 영역의 CRC 를 기록하고 SRAM2 유지 설정.
+ *
+ */
+void Retain_EnterStandby(void)
+{
+#if RETAIN_SRAM2
+    for (uint8_t i = 0; i < RETAIN_REGION_COUNT; i++)
+    {
+        if (header.entry[i].data != NULL)
+        {
+            header.entry[i].crc = Crc_Calculate32(header.entry[i].data, header.entry[i].size);
+        }
+    }
+    HAL_PWREx_EnableSRAM2ContentRetention();
+#else
+    HAL_PWREx_DisableSRAM2ContentRetention();
+#endif
+}
+
+/**
+  * @}
+  */
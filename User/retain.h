@@ -0,0 +1,25 @@
+#ifndef RETAIN_H__
+#define RETAIN_H__ 1
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "main.h"
+
+#define RETAIN_SRAM2 1U   /*!< 1: 스탠바이 중 SRAM2 유지 (약 1uA 추가). 0: 유지하지 않고 깨어날 때마다 초기화 */
+#define RETAIN_VERSION 2U /*!< 보관 영역 구조 버전. 영역의 변수 구성을 바꾸면 증가 */
+
+#define RETAINED __attribute__((section(".retained"))) /*!< SRAM2 에 두는 변수. 시작 코드가 초기화하지 않음 */
+
+typedef enum
+{
+    RETAIN_PROFILE = 0, /*!< 운용모드, AT 명령 소요 시간 통계 (profile.c) */
+    RETAIN_SESSION,     /*!< 재전송할 전송 데이터 (user.c) */
+    RETAIN_REGION_COUNT
+} retainRegion; /*!< SRAM2 보관 영역 */
+
+/* Extern functions ---------------------------------------------------------*/
+void Retain_Init(void);                                        /*!< 보관 영역 헤더 확인 */
+bool Retain_Attach(retainRegion region, void *data, size_t size); /*!< 보관 영역 연결 및 내용 확인 */
+void Retain_EnterStandby(void);                                /*!< 보관 영역 CRC 기록, SRAM2 유지 설정 */
+
+#endif /* RETAIN_H__ */
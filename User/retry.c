@@ -0,0 +1,201 @@
+/**
+  ******************************************************************************
+  * @file    retry.c
+  * @author  정두원
+  * @date    2020-12-17
+  * @brief   깨어남을 넘는 재전송 예약
+  * @details 서버 전송이 실패하면 다음 센싱 주기까지 기다리지 않고, 지수적으로 늘어나는 간격에
+  *          무작위 분산을 더한 시간 후에 깨어나 다시 전송. 깨어나면 LTE 모뎀을 다시 켜므로 처음 단계부터
+  *          보내고, 실패한 단계부터 보내는 것은 같은 깨어남 안의 재시도만. 여러 보드가 같은 시각에
+  *          몰리지 않도록 분산 값은 장치 고유 ID 와 DWT 사이클 카운터로 만듦.
+  *          재전송 상태는 RTC 백업 레지스터에, 전송 데이터는 SRAM2 에 두어 스탠바이 후에도 유지.
+  *          재전송으로 깨어난 시간은 센싱 주기에서 빼서 센싱 간격을 유지.
+  *
+  *          BKP_RETRY: RETRY_MAGIC(8) | 재전송 횟수(4) | 전송 단계(4) | 센싱 주기까지 남은 시간 초(16)
+  */
+
+#include "retry.h"
+#include "backup.h"
+#include "log.h"
+#include "rtc.h"
+
+/** @defgroup RETRY 재전송 예약
+  * @brief 지수 백오프, 무작위 분산, 대기 중인 전송 유지
+  * @{
+  */
+
+#define RETRY_MAGIC 0xA5000000U /*!< 백업 레지스터 유효 표시 */
+#define RETRY_MAGIC_MASK 0xFF000000U
+
+/* Private variables ---------------------------------------------------------*/
+static bool pending;      /*!< 다시 보낼 전송 있음 */
+static uint8_t attempt;   /*!< 깨어나서 다시 보낸 횟수 */
+static uint8_t step;      /*!< 다시 시작할 전송 단계 */
+static uint16_t due;      /*!< 센싱 주기까지 남은 시간. 0 이면 이번 깨어남이 센싱 주기. 단위 초 */
+static uint32_t delaySec; /*!< 이번에 예약한 재전송까지 시간. 0 이면 예약 없음. 단위 초 */
+
+/* Private functions ---------------------------------------------------------*/
+static void save(void);
+static uint32_t getRandom(void);
+
+/**
+ * @brief 백업 레지스터의 대기 중인 전송 불러오기
+ *
+ */
+void Retry_Init(void)
+{
+    uint32_t stored = HAL_RTCEx_BKUPRead(&hrtc, BKP_RETRY);
+
+    pending = ((stored & RETRY_MAGIC_MASK) == RETRY_MAGIC);
+    attempt = pending ? (uint8_t)((stored >> 20) & 0x0FU) : 0U;
+    step = pending ? (uint8_t)((stored >> 16) & 0x0FU) : 0U;
+    due = pending ? (uint16_t)stored : 0U;
+    delaySec = 0U;
+}
+
+/**
+ * @brief 다시 보낼 전송이 있는지 확인
+ *
+ * @return true: 전송 데이터를 새로 만들지 않고 Retry_GetStep() 단계부터 전송
+ */
+bool Retry_IsPending(void)
+{
+    return pending;
+}
+
+/**
+ * @brief 이번 깨어남이 센싱 주기인지 확인. 재전송만 하려고 일찍 깨어났으면 false.
+ *
+ * @return true: 센싱
+ */
+bool Retry_IsSensingDue(void)
+{
+    return !pending || (due == 0U);
+}
+
+/**
+ * @brief 다시 시작할 전송 단계
+ *
+ * @return uint8_t: 전송 순서 번호. 대기 중인 전송이 없으면 0
+ */
+uint8_t Retry_GetStep(void)
+{
+    return step;
+}
+
+/**
+ * @brief 실패한 전송 단계 기록. 같은 깨어남 안의 재시도도 이 단계부터 시작.
+ *
+ * @param failedStep: 다시 시작할 전송 순서 번호 (최대 15)
+ */
+void Retry_SetStep(uint8_t failedStep)
+{
+    step = failedStep & 0x0FU;
+}
+
+/**
+ * @brief 전송 실패. 재전송 횟수가 남아 있으면 재전송 시각을 예약하고 백업 레지스터에 저장.
+ *        재전송 간격은 RETRY_BACKOFF x 2^(횟수 - 1) 의 절반 ~ 전체에서 무작위. 센싱 주기를 넘지 않음.
+ *
+ * @param interval: 센싱 주기. 단위 초
+ */
+void Retry_Fail(uint32_t interval)
+{
+    uint32_t backoff;
+
+    if (attempt >= RETRY_MAX)
+    {
+        LOG_WARN("retry: gave up after %u attempts", attempt);
+        Retry_Clear();
+        return;
+    }
+
+    if (due == 0U) /* 센싱 주기에 실패. 다음 센싱 주기까지 재전송 */
+    {
+        due = (uint16_t)((interval < 0xFFFFU) ? interval : 0xFFFFU);
+    }
+
+    attempt++;
+    backoff = RETRY_BACKOFF << (attempt - 1U);
+    delaySec = (backoff / 2U) + (getRandom() % ((backoff / 2U) + 1U));
+    if (delaySec >= due) /* 센싱 주기와 같이 깨어나 센싱 후 재전송 */
+    {
+        delaySec = due;
+    }
+    due = (uint16_t)(due - delaySec);
+    pending = true;
+    save();
+
+    LOG_INFO("retry: attempt %u from step %u in %u s", attempt, step, delaySec);
+}
+
+/**
+ * @brief 대기 중인 전송 없음. 전송 완료 또는 새 전송 데이터를 만들 때 호출.
+ *        센싱 주기까지 남은 시간은 Retry_GetWakeInterval() 에서 사용.
+ *
+ */
+void Retry_Clear(void)
+{
+    pending = false;
+    attempt = 0U;
+    step = 0U;
+    delaySec = 0U;
+    save();
+}
+
+/**
+ * @brief 다음 깨어날 때까지 시간. 재전송 예약이 있으면 그 시간, 재전송 후이면 센싱 주기까지 남은 시간.
+ *
+ * @param interval: 센싱 주기. 단위 초
+ * @return uint32_t: 단위 초
+ */
+uint32_t Retry_GetWakeInterval(uint32_t interval)
+{
+    if (delaySec != 0U)
+    {
+        return delaySec;
+    }
+    if (due != 0U)
+    {
+        return due;
+    }
+    return interval;
+}
+
+/**
+ * @brief 재전송 상태를 백업 레지스터에 저장
+ *
+ */
+static void save(void)
+{
+    uint32_t value = 0U;
+
+    if (pending)
+    {
+        value = RETRY_MAGIC | ((uint32_t)attempt << 20) | ((uint32_t)step << 16) | due;
+    }
+    HAL_RTCEx_BKUPWrite(&hrtc, BKP_RETRY, value);
+}
+
+/**
+ * @brief 분산용 난수. 장치마다 다르도록 고유 ID 를 섞은 xorshift32.
+ *
+ * @return uint32_t: 난수
+ */
+static uint32_t getRandom(void)
+{
+    uint32_t x = HAL_GetUIDw0() ^ HAL_GetUIDw1() ^ HAL_GetUIDw2() ^ DWT->CYCCNT ^ HAL_GetTick();
+
+    if (x == 0U)
+    {
+        x = 0x6D2B79F5U;
+    }
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,20 @@
+#ifndef RETRY_H__
+#define RETRY_H__ 1
+
+#include <stdbool.h>
+#include "main.h"
+
+#define RETRY_MAX 4U      /*!< 전송 실패 후 깨어나서 다시 전송하는 최대 횟수 */
+#define RETRY_BACKOFF 60U /*!< 첫 재전송까지 대기 시간. 재전송마다 2배, 절반 범위에서 무작위 분산. 단위: 초 */
+
+/* Extern functions ---------------------------------------------------------*/
+void Retry_Init(void);                             /*!< 백업 레지스터의 대기 중인 전송 불러오기 */
+bool Retry_IsPending(void);                        /*!< 다시 보낼 전송 있음 */
+bool Retry_IsSensingDue(void);                     /*!< 이번 깨어남이 센싱 주기 */
+uint8_t Retry_GetStep(void);                       /*!< 다시 시작할 전송 단계 */
+void Retry_SetStep(uint8_t step);                  /*!< 실패한 전송 단계 기록 */
+void Retry_Fail(uint32_t interval);                /*!< 전송 실패. 재전송 시각 예약 */
+void Retry_Clear(void);                            /*!< 대기 중인 전송 없음 */
+uint32_t Retry_GetWakeInterval(uint32_t interval); /*!< 다음 깨어날 때까지 시간 */
+
+#endif /* RETRY_H__ */
@@ -0,0 +1,181 @@
+#ifndef RING_H__
+#define RING_H__ 1
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "main.h"
+
+/**
+ * @brief 단일 생산자, 단일 소비자 링 버퍼. 인터럽트 금지 없이 사용 가능.
+ * @note  크기는 2의 거듭제곱. in, out 은 계속 증가하고 사용할 때만 마스크하므로
+ *        in - out 이 저장된 데이터 갯수이며 가득 찬 상태와 빈 상태를 구분함.
+ *        in 은 생산자만, out 은 소비자만 씀.
+ */
+typedef struct
+{
+    uint8_t *buff;         /*!< 데이터 버퍼 */
+    uint16_t mask;         /*!< 크기 - 1 */
+    volatile uint16_t in;  /*!< 쓰기 인덱스. 생산자 소유 */
+    volatile uint16_t out; /*!< 읽기 인덱스. 소비자 소유 */
+} ring_TypeDef;            /*!< SPSC 링 버퍼 구조체 */
+
+/**
+ * @brief 링 버퍼 초기화. 생산자, 소비자가 모두 멈춘 상태에서 호출.
+ *
+ * @param ring: 링 버퍼 구조체 포인터
+ * @param buff: 데이터 버퍼
+ * @param size: 버퍼 크기. 2의 거듭제곱, 최대 32768
+ */
+static inline void Ring_Init(ring_TypeDef *ring, uint8_t *buff, uint16_t size)
+{
+    ring->buff = buff;
+    ring->mask = (uint16_t)(size - 1U);
+    ring->in = 0U;
+    ring->out = 0U;
+}
+
+/**
+ * @brief 저장된 데이터 갯수
+ */
+static inline uint16_t Ring_Count(const ring_TypeDef *ring)
+{
+    return (uint16_t)(ring->in - ring->out);
+}
+
+/**
+ * @brief 남은 공간
+ */
+static inline uint16_t Ring_Free(const ring_TypeDef *ring)
+{
+    return (uint16_t)(ring->mask + 1U - Ring_Count(ring));
+}
+
+/**
+ * @brief index 위치의 데이터. index 는 out 이상 in 미만의 계속 증가하는 인덱스.
+ */
+static inline uint8_t Ring_At(const ring_TypeDef *ring, uint16_t index)
+{
+    return ring->buff[index & ring->mask];
+}
+
+/**
+ * @brief 1byte 저장 (생산자)
+ *
+ * @return bool: 가득 차면 false
+ */
+static inline bool Ring_Put(ring_TypeDef *ring, uint8_t ch)
+{
+    uint16_t in = ring->in;
+
+    if ((uint16_t)(in - ring->out) > ring->mask)
+    {
+        return false;
+    }
+    ring->buff[in & ring->mask] = ch;
+    __DMB(); /* 데이터 저장 후 인덱스 공개 */
+    ring->in = (uint16_t)(in + 1U);
+    return true;
+}
+
+/**
+ * @brief 1byte 읽기 (소비자)
+ *
+ * @return bool: 비어 있으면 false
+ */
+static inline bool Ring_Get(ring_TypeDef *ring, uint8_t *ch)
+{
+    uint16_t out = ring->out;
+
+    if (out == ring->in)
+    {
+        return false;
+    }
+    *ch = ring->buff[out & ring->mask];
+    __DMB(); /* 데이터 읽은 후 공간 반환 */
+    ring->out = (uint16_t)(out + 1U);
+    return true;
+}
+
+/**
+ * @brief 바로 읽을 수 있는 연속 영역 (소비자). 링 버퍼 끝에서 나뉘면 앞부분만 반환.
+ *
+ * @param data: 영역 시작 위치
+ * @return uint16_t: 영역 길이. 읽은 후 Ring_Consume() 호출
+ */
+static inline uint16_t Ring_ReadSpan(const ring_TypeDef *ring, const uint8_t **data)
+{
+    uint16_t out = ring->out;
+    uint16_t count = (uint16_t)(ring->in - out);
+    uint16_t index = out & ring->mask;
+    uint16_t toEnd = (uint16_t)(ring->mask + 1U - index);
+
+    *data = &ring->buff[index];
+    return (count < toEnd) ? count : toEnd;
+}
+
+/**
+ * @brief 읽은 데이터 반환 (소비자)
+ */
+static inline void Ring_Consume(ring_TypeDef *ring, uint16_t length)
+{
+    __DMB();
+    ring->out = (uint16_t)(ring->out + length);
+}
+
+/**
+ * @brief 바로 쓸 수 있는 연속 영역 (생산자). 링 버퍼 끝에서 나뉘면 앞부분만 반환.
+ *
+ * @param data: 영역 시작 위치
+ * @return uint16_t: 영역 길이. 쓴 후 Ring_Commit() 호출
+ */
+static inline uint16_t Ring_WriteSpan(ring_TypeDef *ring, uint8_t **data)
+{
+    uint16_t in = ring->in;
+    uint16_t free = (uint16_t)(ring->mask + 1U - (uint16_t)(in - ring->out));
+    uint16_t index = in & ring->mask;
+    uint16_t toEnd = (uint16_t)(ring->mask + 1U - index);
+
+    *data = &ring->buff[index];
+    return (free < toEnd) ? free : toEnd;
+}
+
+/**
+ * @brief 쓴 데이터 공개 (생산자)
+ */
+static inline void Ring_Commit(ring_TypeDef *ring, uint16_t length)
+{
+    __DMB();
+    ring->in = (uint16_t)(ring->in + length);
+}
+
+/**
+ * @brief Circular DMA 가 생산자일 때 DMA 쓰기 위치로 in 갱신. 인터럽트에서 호출.
+ * @note  반 바퀴마다(DMA 절반/완료 인터럽트) 호출되어야 한 바퀴를 놓치지 않음.
+ *        DMA 가 이동한 거리가 남은 공간보다 크면 읽지 않은 데이터를 덮어쓴 것. in 은 그대로 DMA 위치를
+ *        따라가 Ring_Count() 가 크기를 넘으므로 소비자가 Ring_IsOverrun() 으로 확인하고 버림.
+ *        인터럽트가 한 바퀴 이상 늦으면 위치만으로는 구분할 수 없음.
+ *
+ * @param position: 버퍼 내 DMA 쓰기 위치 (크기 - CNDTR)
+ * @return bool: DMA 가 읽지 않은 데이터를 덮어쓰면 false
+ */
+static inline bool Ring_SyncDMA(ring_TypeDef *ring, uint16_t position)
+{
+    uint16_t in = ring->in;
+    uint16_t free = Ring_Free(ring); /* 이미 덮어쓴 상태이면 음수가 넘어가 큰 값. 한 번만 알림 */
+    uint16_t moved = (uint16_t)(position - in) & ring->mask;
+
+    ring->in = (uint16_t)(in + moved);
+    return (moved <= free);
+}
+
+/**
+ * @brief DMA 가 읽지 않은 데이터를 덮어썼는지 확인 (소비자)
+ *
+ * @return bool: true 이면 저장된 데이터를 믿을 수 없음. 버린 후 사용
+ */
+static inline bool Ring_IsOverrun(const ring_TypeDef *ring)
+{
+    return (Ring_Count(ring) > (uint16_t)(ring->mask + 1U));
+}
+
+#endif /* RING_H__ */
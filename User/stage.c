@@ -0,0 +1,281 @@
+/**
+  ******************************************************************************
+  * @file    stage.c
+  * @author  정두원
+  * @date    2020-12-11
+  * @brief   운용모드 상태 머신
+  * @details 운용모드마다 진입, 종료 동작과 제한 시간, 재시도 횟수, 재시도 간격, 실패 시
+  *          전환할 운용모드를 표로 정의. 전환은 요청만 기록하고 Stage_Process() 에서 수행하므로
+  *          콜백이나 진입 동작 안에서 전환을 요청해도 중첩되지 않음. 전환마다 시각을 기록.
+  */
+
+#include "stage.h"
+#include "timer.h"
+#include "event.h"
+#include "log.h"
+#include "profile.h"
+
+/** @defgroup STAGE 운용모드 상태 머신
+  * @brief 표 기반 운용모드 전환, 제한 시간, 재시도
+  * @{
+  */
+
+/* Private variables ---------------------------------------------------------*/
+static const stage_TypeDef *stageTable; /*!< 운용모드 표 */
+static uint8_t stageCount;              /*!< 운용모드 갯수 */
+static uint8_t current = STAGE_NONE;    /*!< 현재 운용모드 */
+static uint8_t retryCount;              /*!< 현재 운용모드 재시도 횟수 */
+static bool pending = false;            /*!< 전환 요청 있음 */
+static uint8_t pendingStage;            /*!< 전환할 운용모드 */
+static bool pendingRetry;               /*!< 같은 운용모드 재시도 */
+static timer_TypeDef timeoutTimer;      /*!< 운용모드 제한 시간 */
+static timer_TypeDef backoffTimer;      /*!< 재시도 전 대기 */
+
+static stageTrace_TypeDef trace[STAGE_TRACE_SIZE]; /*!< 전환 기록. 가득 차면 오래된 것부터 덮어씀 */
+static uint8_t traceCount;                         /*!< 전체 기록 갯수 (최대 255) */
+static uint8_t traceNext;                          /*!< 다음 기록 위치 */
+
+/* Private functions ---------------------------------------------------------*/
+static void request(uint8_t stage, bool retry);
+static void transition(uint8_t next, bool retry);
+static uint32_t backoffTime(uint32_t backoff, uint8_t retry);
+static void enterCurrent(void);
+static void record(void);
+static void onTimeout(timer_TypeDef *timer);
+static void onBackoff(timer_TypeDef *timer);
+
+/**
+ * @brief 운용모드 표 설정. 첫 운용모드는 Stage_Set() 으로 요청.
+ *
+ * @param table: 운용모드 번호 순서의 표
+ * @param count: 운용모드 갯수
+ */
+void Stage_Init(const stage_TypeDef *table, uint8_t count)
+{
+    stageTable = table;
+    stageCount = count;
+    current = STAGE_NONE;
+    pending = false;
+    traceCount = 0U;
+    traceNext = 0U;
+    Timer_Init(&timeoutTimer, onTimeout);
+    Timer_Init(&backoffTimer, onBackoff);
+}
+
+/**
+ * @brief 운용모드 전환 요청. Stage_Process() 에서 현재 운용모드 종료 후 진입.
+ *        여러 번 요청하면 마지막 요청으로 전환. 사용자 Loop 에서만 호출.
+ *
+ * @param stage: 전환할 운용모드
+ */
+void Stage_Set(uint8_t stage)
+{
+    request(stage, false);
+}
+
+/**
+ * @brief 현재 운용모드 실패. 재시도 횟수가 남아 있으면 재시도 간격 후 다시 진입, 아니면 실패 운용모드로 전환.
+ *        제한 시간이 지나도 호출됨.
+ *
+ */
+void Stage_Fail(void)
+{
+    const stage_TypeDef *stage;
+
+    if (current == STAGE_NONE)
+    {
+        return;
+    }
+
+    stage = &stageTable[current];
+    if (retryCount < stage->retry)
+    {
+        request(current, true);
+    }
+    else
+    {
+        LOG_WARN("stage %u failed after %u retries", current, retryCount);
+        request(stage->failStage, false);
+    }
+}
+
+/**
+ * @brief 현재 운용모드
+ *
+ * @return uint8_t: 운용모드. 시작 전이면 STAGE_NONE
+ */
+uint8_t Stage_Get(void)
+{
+    return current;
+}
+
+/**
+ * @brief 요청된 전환을 수행하고 현재 운용모드의 매 Loop 동작 실행. 사용자 Loop 에서 매번 호출.
+ *
+ */
+void Stage_Process(void)
+{
+    while (pending) /* 진입 동작에서 다시 전환 요청 가능 */
+    {
+        pending = false;
+        transition(pendingStage, pendingRetry);
+    }
+
+    if ((current != STAGE_NONE) && !Timer_IsRunning(&backoffTimer) && (stageTable[current].process != NULL))
+    {
+        stageTable[current].process();
+    }
+
+    while (pending)
+    {
+        pending = false;
+        transition(pendingStage, pendingRetry);
+    }
+}
+
+/**
+ * @brief 전환 기록을 오래된 것부터 로그로 출력. 다음 기록과의 차이가 그 운용모드에 머문 시간.
+ *
+ */
+void Stage_LogTrace(void)
+{
+    uint8_t count = (traceCount < STAGE_TRACE_SIZE) ? traceCount : STAGE_TRACE_SIZE;
+    uint8_t index = (uint8_t)((traceNext + STAGE_TRACE_SIZE - count) % STAGE_TRACE_SIZE);
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        LOG_INFO("trace: %u ms stage %u retry %u", trace[index].tick, trace[index].stage, trace[index].retry);
+        index = (uint8_t)((index + 1U) % STAGE_TRACE_SIZE);
+    }
+}
+
+/**
+ * @brief 전환 요청 기록
+ *
+ * @param stage: 전환할 운용모드
+ * @param retry: 같은 운용모드 재시도
+ */
+static void request(uint8_t stage, bool retry)
+{
+    if (stage >= stageCount)
+    {
+        return;
+    }
+    pendingStage = stage;
+    pendingRetry = retry;
+    pending = true;
+    Event_Post(EVENT_STATE);
+}
+
+/**
+ * @brief 현재 운용모드를 종료하고 다음 운용모드 진입. 재시도면 재시도 간격 후 진입.
+ *
+ * @param next: 다음 운용모드
+ * @param retry: 같은 운용모드 재시도
+ */
+static void transition(uint8_t next, bool retry)
+{
+    Timer_Stop(&timeoutTimer);
+    Timer_Stop(&backoffTimer);
+    if ((current != STAGE_NONE) && (stageTable[current].exit != NULL))
+    {
+        stageTable[current].exit();
+    }
+
+    current = next;
+    if (!retry)
+    {
+        retryCount = 0U; /* 다른 운용모드로 가면 재시도 횟수 초기화 */
+        enterCurrent();
+        return;
+    }
+
+    retryCount++;
+    if (stageTable[current].backoff == 0U)
+    {
+        enterCurrent();
+    }
+    else
+    {
+        (void)Timer_Start(&backoffTimer, backoffTime(stageTable[current].backoff, retryCount), false);
+    }
+}
+
+/**
+ * @brief 재시도 간격. 첫 재시도는 backoff, 이후 2배씩 늘리고 STAGE_BACKOFF_MAX 에서 멈춤.
+ *
+ * @param backoff: 첫 재시도 전 대기 시간. 단위 ms
+ * @param retry: 재시도 횟수. 1 부터
+ * @return uint32_t: 대기 시간. 단위 ms
+ */
+static uint32_t backoffTime(uint32_t backoff, uint8_t retry)
+{
+    uint8_t shift = (uint8_t)(retry - 1U);
+
+    if ((shift >= 31U) || (backoff > (STAGE_BACKOFF_MAX >> shift)))
+    {
+        return STAGE_BACKOFF_MAX;
+    }
+    return backoff << shift;
+}
+
+/**
+ * @brief 현재 운용모드 진입 동작 실행 및 제한 시간 시작
+ *
+ */
+static void enterCurrent(void)
+{
+    const stage_TypeDef *stage = &stageTable[current];
+
+    record();
+    if (stage->timeout != 0U)
+    {
+        (void)Timer_Start(&timeoutTimer, stage->timeout, false);
+    }
+    if (stage->entry != NULL)
+    {
+        stage->entry();
+    }
+}
+
+/**
+ * @brief 현재 운용모드 진입 기록
+ *
+ */
+static void record(void)
+{
+    trace[traceNext].tick = HAL_GetTick();
+    trace[traceNext].stage = current;
+    trace[traceNext].retry = retryCount;
+    traceNext = (uint8_t)((traceNext + 1U) % STAGE_TRACE_SIZE);
+    if (traceCount < 0xFFU)
+    {
+        traceCount++;
+    }
+    Profile_StageEnter(current);
+}
+
+/**
+ * @brief 제한 시간 타이머 콜백
+ *
+ * @param timer: 제한 시간 타이머
+ */
+static void onTimeout(timer_TypeDef *timer)
+{
+    LOG_WARN("stage %u timeout", current);
+    Stage_Fail();
+}
+
+/**
+ * @brief 재시도 간격 타이머 콜백. 같은 운용모드 다시 진입.
+ *
+ * @param timer: 재시도 간격 타이머
+ */
+static void onBackoff(timer_TypeDef *timer)
+{
+    enterCurrent();
+}
+
+/**
+  * @}
+  */
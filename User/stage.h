@@ -0,0 +1,42 @@
+#ifndef STAGE_H__
+#define STAGE_H__ 1
+
+#include <stdbool.h>
+#include "main.h"
+
+#define STAGE_TRACE_SIZE 16U /*!< 기록할 운용모드 전환 갯수 */
+#define STAGE_NONE 0xFFU     /*!< 운용모드 없음 (시작 전) */
+#define STAGE_BACKOFF_MAX 600000U /*!< 재시도 간격 최대값. 2배씩 늘리다 넘으면 이 값. 단위 ms */
+
+/**
+ * @brief 운용모드 진입, 종료, 매 Loop 동작
+ */
+typedef void (*stageAction_TypeDef)(void);
+
+typedef struct
+{
+    stageAction_TypeDef entry;   /*!< 진입 동작. 재시도 시에도 호출. NULL 가능 */
+    stageAction_TypeDef exit;    /*!< 종료 동작. 재시도 전에도 호출. NULL 가능 */
+    stageAction_TypeDef process; /*!< 매 Loop 동작. NULL 가능 */
+    uint32_t timeout;            /*!< 진입 후 제한 시간. 초과하면 Stage_Fail(). 단위 ms, 0 이면 없음 */
+    uint8_t retry;               /*!< 실패 시 다시 진입하는 횟수 */
+    uint32_t backoff;            /*!< 첫 재시도 전 대기 시간. 재시도마다 2배, STAGE_BACKOFF_MAX 까지. 단위 ms */
+    uint8_t failStage;           /*!< 재시도 후에도 실패하면 전환할 운용모드 */
+} stage_TypeDef;                 /*!< 운용모드 정의. 운용모드 번호 순서로 표를 만듦 */
+
+typedef struct
+{
+    uint32_t tick; /*!< 진입 시각. HAL_GetTick() 기준 */
+    uint8_t stage; /*!< 진입한 운용모드 */
+    uint8_t retry; /*!< 재시도 횟수. 0 이면 처음 진입 */
+} stageTrace_TypeDef; /*!< 운용모드 전환 기록 */
+
+/* Extern functions ---------------------------------------------------------*/
+void Stage_Init(const stage_TypeDef *table, uint8_t count); /*!< 운용모드 표 설정 */
+void Stage_Set(uint8_t stage);                              /*!< 운용모드 전환 요청 */
+void Stage_Fail(void);                                      /*!< 현재 운용모드 실패. 재시도 또는 실패 운용모드로 전환 */
+uint8_t Stage_Get(void);                                    /*!< 현재 운용모드 */
+void Stage_Process(void);                                   /*!< 전환 처리 및 매 Loop 동작 */
+void Stage_LogTrace(void);                                  /*!< 전환 기록 로그 출력 */
+
+#endif /* STAGE_H__ */
@@ -0,0 +1,224 @@
+/**
+  ******************************************************************************
+  * @file    timebase.c
+  * @author  정두원
+  * @date    2020-12-09
+  * @brief   Tickless 시간 기준
+  * @details LSE 로 동작하는 LPTIM1 을 계속 세어 HAL_GetTick() 을 제공하므로 Stop 모드에서도
+  *          시간이 유지되고, 1ms 주기 인터럽트(SysTick, TIM6) 없이 동작함. 대기 직전 가장 가까운
+  *          타이머 만료 시각 하나만 LPTIM1 비교 값으로 설정하고 그 시각에 EVENT_TICK 발생.
+  */
+
+#include <stdbool.h>
+#include "timebase.h"
+#include "event.h"
+
+/** @defgroup TIMEBASE Tickless 시간 기준
+  * @brief LPTIM1 시간 기준 및 깨우기 알람
+  * @{
+  */
+
+/* Private variables ---------------------------------------------------------*/
+static volatile bool started = false;           /*!< LPTIM1 시간 기준 사용 중 */
+static volatile uint32_t overflowCount;         /*!< LPTIM1 카운터 한 바퀴 횟수 */
+static uint32_t tickOffset;                     /*!< 시작 전 SysTick 으로 센 시간. 단위 ms */
+static uint32_t alarmTick;                      /*!< 설정된 알람 시각. 단위 ms */
+static bool alarmArmed = false;                 /*!< 알람 설정됨 */
+
+/* Private functions ---------------------------------------------------------*/
+static uint16_t readCounter(void);
+static uint64_t readTicks(void);
+static void setCompare(uint16_t compare);
+
+/**
+ * @brief LPTIM1 을 LSE / 32 로 계속 세도록 설정하고 HAL 시간 기준을 LPTIM1 으로 전환.
+ * @note  HAL LPTIM 드라이버 없이 레지스터로 설정. IER, CFGR 은 LPTIM 이 꺼진 상태에서만 쓸 수 있음.
+ *        전환 후 SysTick 은 정지. HAL_Delay() 는 HAL_GetTick() 으로 동작하므로 SysTick 이 필요 없음.
+ *
+ */
+void Timebase_Init(void)
+{
+    __HAL_RCC_LPTIM1_CONFIG(RCC_LPTIM1CLKSOURCE_LSE);
+    __HAL_RCC_LPTIM1_CLK_ENABLE();
+
+    LPTIM1->CR = 0U;
+    LPTIM1->CFGR = LPTIM_CFGR_PRESC_2 | LPTIM_CFGR_PRESC_0; /* 1/32 */
+    LPTIM1->IER = LPTIM_IER_CMPMIE | LPTIM_IER_ARRMIE;
+    LPTIM1->CR = LPTIM_CR_ENABLE;
+
+    LPTIM1->ARR = 0xFFFFU;
+    while ((LPTIM1->ISR & LPTIM_ISR_ARROK) == 0U)
+    {
+    }
+    LPTIM1->ICR = LPTIM_ICR_ARROKCF;
+
+    HAL_NVIC_SetPriority(LPTIM1_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(LPTIM1_IRQn);
+
+    __disable_irq();
+    tickOffset = HAL_GetTick();
+    overflowCount = 0U;
+    LPTIM1->CR |= LPTIM_CR_CNTSTRT; /* 연속 모드 시작 */
+    started = true;
+    HAL_SuspendTick();
+    __enable_irq();
+}
+
+/**
+ * @brief HAL 시간 기준. LPTIM1 시작 전에는 SysTick 으로 센 시간.
+ * @note  분해능은 LPTIM1 1카운트(1/1024초). 인터럽트에서도 호출 가능.
+ *
+ * @return uint32_t: 부팅 후 시간. 단위 ms
+ */
+uint32_t HAL_GetTick(void)
+{
+    if (!started)
+    {
+        return uwTick;
+    }
+    return tickOffset + (uint32_t)((readTicks() * 1000U) / TIMEBASE_FREQ);
+}
+
+/**
+ * @brief LPTIM1 알람 설정. 대기 직전 인터럽트 금지 상태로 호출. 이미 지난 시각이면 바로 EVENT_TICK 발생.
+ *
+ * @param tick: 알람 시각. HAL_GetTick() 기준, 단위 ms
+ */
+void Timebase_SetAlarm(uint32_t tick)
+{
+    uint32_t now = HAL_GetTick();
+    int32_t delay = (int32_t)(tick - now);
+    uint16_t compare;
+
+    if (delay <= 0)
+    {
+        Event_Post(EVENT_TICK);
+        return;
+    }
+    if ((uint32_t)delay > TIMEBASE_ALARM_MAX) /* 한 바퀴 안에서 깨어나 다시 설정 */
+    {
+        delay = TIMEBASE_ALARM_MAX;
+    }
+
+    if (alarmArmed && (alarmTick == (now + (uint32_t)delay))) /* 같은 알람. CMP 쓰기 동기화 대기 생략 */
+    {
+        return;
+    }
+    alarmTick = now + (uint32_t)delay;
+    alarmArmed = true;
+
+    compare = (uint16_t)(readCounter() + ((((uint32_t)delay * TIMEBASE_FREQ) + 999U) / 1000U)); /* 올림. 깨어나면 요청 시각이 지나 있음 */
+    setCompare(compare);
+    if ((int16_t)(compare - readCounter()) <= 0) /* 설정하는 사이 지남 */
+    {
+        Event_Post(EVENT_TICK);
+    }
+}
+
+/**
+ * @brief 알람 해제. 이미 설정된 비교 값으로 깨어나도 EVENT_TICK 만 발생하므로 LPTIM1 은 건드리지 않음.
+ *
+ */
+void Timebase_CancelAlarm(void)
+{
+    alarmArmed = false;
+}
+
+/**
+ * @brief 설정된 알람까지 남은 시간
+ *
+ * @return uint32_t: 단위 ms. 알람이 없으면 TIMEBASE_NO_ALARM
+ */
+uint32_t Timebase_GetTimeToAlarm(void)
+{
+    int32_t remain;
+
+    if (!alarmArmed)
+    {
+        return TIMEBASE_NO_ALARM;
+    }
+    remain = (int32_t)(alarmTick - HAL_GetTick());
+    return (remain > 0) ? (uint32_t)remain : 0U;
+}
+
+/**
+ * @brief LPTIM1 인터럽트. 비교 일치는 알람, 자동 리로드 일치는 카운터 한 바퀴.
+ *
+ */
+void LPTIM1_IRQHandler(void)
+{
+    uint32_t isr = LPTIM1->ISR;
+
+    if ((isr & LPTIM_ISR_ARRM) != 0U)
+    {
+        LPTIM1->ICR = LPTIM_ICR_ARRMCF;
+        overflowCount++;
+    }
+    if ((isr & LPTIM_ISR_CMPM) != 0U)
+    {
+        LPTIM1->ICR = LPTIM_ICR_CMPMCF;
+        alarmArmed = false;
+        Event_Post(EVENT_TICK);
+    }
+}
+
+/**
+ * @brief 시작 후 LPTIM1 카운트. 처리하지 않은 한 바퀴 플래그도 반영.
+ *
+ * @return uint64_t: 카운트
+ */
+static uint64_t readTicks(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t overflow;
+    uint16_t counter;
+
+    __disable_irq();
+    overflow = overflowCount;
+    counter = readCounter();
+    if (((LPTIM1->ISR & LPTIM_ISR_ARRM) != 0U) && (counter < 0x8000U)) /* 한 바퀴 인터럽트 처리 전 */
+    {
+        overflow++;
+    }
+    __set_PRIMASK(primask);
+
+    return ((uint64_t)overflow << 16) | counter;
+}
+
+/**
+ * @brief LPTIM1 카운터 읽기. 비동기 클럭이므로 연속 2번 같은 값이 읽힐 때까지 반복.
+ *
+ * @return uint16_t: 카운터 값
+ */
+static uint16_t readCounter(void)
+{
+    uint16_t first;
+    uint16_t second = (uint16_t)LPTIM1->CNT;
+
+    do
+    {
+        first = second;
+        second = (uint16_t)LPTIM1->CNT;
+    } while (first != second);
+
+    return second;
+}
+
+/**
+ * @brief LPTIM1 비교 값 설정. CMP 는 ARR 보다 작아야 함.
+ *
+ * @param compare: 비교 값
+ */
+static void setCompare(uint16_t compare)
+{
+    LPTIM1->ICR = LPTIM_ICR_CMPOKCF;
+    LPTIM1->CMP = (compare == 0xFFFFU) ? 0U : compare;
+    while ((LPTIM1->ISR & LPTIM_ISR_CMPOK) == 0U) /* LSE 클럭 몇 주기 동안 동기화 */
+    {
+    }
+    LPTIM1->ICR = LPTIM_ICR_CMPMCF;
+}
+
+/**
+  * @}
+  */
@@ -0,0 +1,16 @@
+#ifndef TIMEBASE_H__
+#define TIMEBASE_H__ 1
+
+#include "main.h"
+
+#define TIMEBASE_FREQ (LSE_VALUE / 32U) /*!< LPTIM1 카운터 주파수. LSE / 32 = 1024Hz */
+#define TIMEBASE_ALARM_MAX 60000U       /*!< 알람 최대 간격. LPTIM1 16비트 카운터 한 바퀴(64초) 미만. 단위: ms */
+#define TIMEBASE_NO_ALARM 0xFFFFFFFFU   /*!< Timebase_GetTimeToAlarm() 에서 알람 없음 */
+
+/* Extern functions ---------------------------------------------------------*/
+void Timebase_Init(void);                 /*!< LPTIM1 시간 기준 시작. SysTick 정지 */
+void Timebase_SetAlarm(uint32_t tick);    /*!< 지정 시각에 EVENT_TICK 발생 */
+void Timebase_CancelAlarm(void);          /*!< 알람 해제 */
+uint32_t Timebase_GetTimeToAlarm(void);   /*!< 설정된 알람까지 남은 시간 */
+
+#endif /* TIMEBASE_H__ */
@@ -0,0 +1,262 @@
+/**
+  ******************************************************************************
+  * @file    timer.c
+  * @author  정두원
+  * @date    2020-12-10
+  * @brief   소프트웨어 타이머
+  * @details 동작 중인 타이머를 만료 시각 순 최소 힙으로 관리. 가장 가까운 만료 시각 하나만
+  *          timebase.c 의 LPTIM1 알람으로 설정하므로 인터럽트는 EVENT_TICK 만 알리고,
+  *          만료 검사와 콜백은 사용자 Loop 의 Timer_Process() 에서 수행.
+  *          모든 함수는 사용자 Loop 에서만 호출.
+  */
+
+#include "timer.h"
+#include "timebase.h"
+
+/** @defgroup TIMER 소프트웨어 타이머
+  * @brief 1회, 주기 타이머 및 만료 시각 힙
+  * @{
+  */
+
+/* Private variables ---------------------------------------------------------*/
+static timer_TypeDef *heap[TIMER_MAX]; /*!< 만료 시각 최소 힙. heap[0] 이 가장 먼저 만료 */
+static uint8_t heapCount;              /*!< 동작 중인 타이머 갯수 */
+
+/* Private functions ---------------------------------------------------------*/
+static bool isBefore(const timer_TypeDef *a, const timer_TypeDef *b);
+static void place(uint8_t index, timer_TypeDef *timer);
+static void siftUp(uint8_t index);
+static void siftDown(uint8_t index);
+static ErrorStatus insert(timer_TypeDef *timer);
+static void removeAt(uint8_t index);
+
+/**
+ * @brief 타이머 초기화. 정지 상태로 시작.
+ *
+ * @param timer: 타이머
+ * @param callback: 만료 콜백
+ */
+void Timer_Init(timer_TypeDef *timer, timerCallback_TypeDef callback)
+{
+    timer->deadline = 0U;
+    timer->interval = 0U;
+    timer->periodic = false;
+    timer->index = TIMER_INACTIVE;
+    timer->callback = callback;
+}
+
+/**
+ * @brief 타이머 시작. 동작 중이면 지금부터 다시 시작.
+ *
+ * @param timer: 타이머
+ * @param interval: 만료 간격. 단위 ms, 최소 1
+ * @param periodic: true 면 주기 타이머
+ * @return ErrorStatus: 동작 중인 타이머가 TIMER_MAX 개면 ERROR
+ */
+ErrorStatus Timer_Start(timer_TypeDef *timer, uint32_t interval, bool periodic)
+{
+    timer->interval = (interval != 0U) ? interval : 1U;
+    timer->periodic = periodic;
+    return Timer_Restart(timer);
+}
+
+/**
+ * @brief 마지막으로 시작한 간격으로 지금부터 다시 시작
+ *
+ * @param timer: 타이머
+ * @return ErrorStatus: 동작 중인 타이머가 TIMER_MAX 개면 ERROR
+ */
+ErrorStatus Timer_Restart(timer_TypeDef *timer)
+{
+    Timer_Stop(timer);
+    timer->deadline = HAL_GetTick() + timer->interval;
+    return insert(timer);
+}
+
+/**
+ * @brief 타이머 정지. 정지 상태면 아무것도 하지 않음.
+ *
+ * @param timer: 타이머
+ */
+void Timer_Stop(timer_TypeDef *timer)
+{
+    if (timer->index != TIMER_INACTIVE)
+    {
+        removeAt(timer->index);
+    }
+}
+
+/**
+ * @brief 동작 중 여부
+ *
+ * @return true: 동작 중
+ */
+bool Timer_IsRunning(const timer_TypeDef *timer)
+{
+    return timer->index != TIMER_INACTIVE;
+}
+
+/**
+ * @brief 만료까지 남은 시간
+ *
+ * @return uint32_t: 단위 ms. 정지 상태거나 만료되었으면 0
+ */
+uint32_t Timer_GetRemaining(const timer_TypeDef *timer)
+{
+    int32_t remain = (int32_t)(timer->deadline - HAL_GetTick());
+
+    return (Timer_IsRunning(timer) && (remain > 0)) ? (uint32_t)remain : 0U;
+}
+
+/**
+ * @brief 만료된 타이머 콜백 실행. 사용자 Loop 에서 매번 호출.
+ * @note  가장 먼저 만료되는 타이머만 확인하므로 만료된 타이머가 없으면 O(1).
+ *
+ */
+void Timer_Process(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    while ((heapCount > 0U) && ((int32_t)(now - heap[0]->deadline) >= 0))
+    {
+        timer_TypeDef *timer = heap[0];
+
+        removeAt(0U);
+        if (timer->periodic) /* 콜백 전에 다시 넣어 콜백에서 정지할 수 있게 함 */
+        {
+            timer->deadline += timer->interval;
+            if ((int32_t)(now - timer->deadline) >= 0) /* 여러 주기가 지났으면 밀린 만료는 건너뜀 */
+            {
+                timer->deadline = now + timer->interval;
+            }
+            (void)insert(timer);
+        }
+        timer->callback(timer);
+    }
+}
+
+/**
+ * @brief 가장 가까운 만료 시각으로 LPTIM1 알람 설정. Event_Wait() 에서 대기 직전 호출.
+ *
+ */
+void Timer_ArmNext(void)
+{
+    if (heapCount > 0U)
+    {
+        Timebase_SetAlarm(heap[0]->deadline);
+    }
+    else
+    {
+        Timebase_CancelAlarm();
+    }
+}
+
+/**
+ * @brief 만료 시각 비교. HAL_GetTick() 이 한 바퀴 돌아도 간격이 24일 이내면 올바름.
+ *
+ * @return true: a 가 먼저 만료
+ */
+static bool isBefore(const timer_TypeDef *a, const timer_TypeDef *b)
+{
+    return (int32_t)(a->deadline - b->deadline) < 0;
+}
+
+/**
+ * @brief 힙 index 위치에 타이머 저장
+ */
+static void place(uint8_t index, timer_TypeDef *timer)
+{
+    heap[index] = timer;
+    timer->index = index;
+}
+
+/**
+ * @brief index 위치의 타이머를 부모보다 늦어질 때까지 올림
+ */
+static void siftUp(uint8_t index)
+{
+    timer_TypeDef *timer = heap[index];
+
+    while (index > 0U)
+    {
+        uint8_t parent = (uint8_t)((index - 1U) / 2U);
+
+        if (!isBefore(timer, heap[parent]))
+        {
+            break;
+        }
+        place(index, heap[parent]);
+        index = parent;
+    }
+    place(index, timer);
+}
+
+/**
+ * @brief index 위치의 타이머를 자식보다 빨라질 때까지 내림
+ */
+static void siftDown(uint8_t index)
+{
+    timer_TypeDef *timer = heap[index];
+
+    for (;;)
+    {
+        uint8_t child = (uint8_t)((index * 2U) + 1U);
+
+        if (child >= heapCount)
+        {
+            break;
+        }
+        if (((child + 1U) < heapCount) && isBefore(heap[child + 1U], heap[child]))
+        {
+            child++;
+        }
+        if (!isBefore(heap[child], timer))
+        {
+            break;
+        }
+        place(index, heap[child]);
+        index = child;
+    }
+    place(index, timer);
+}
+
+/**
+ * @brief 힙에 타이머 추가
+ *
+ * @return ErrorStatus: 힙이 가득 차면 ERROR
+ */
+static ErrorStatus insert(timer_TypeDef *timer)
+{
+    if (heapCount >= TIMER_MAX)
+    {
+        return ERROR;
+    }
+    place(heapCount, timer);
+    heapCount++;
+    siftUp(timer->index);
+    return SUCCESS;
+}
+
+/**
+ * @brief 힙에서 index 위치의 타이머 제거. 마지막 타이머를 그 자리로 옮겨 힙 순서 복구.
+ */
+static void removeAt(uint8_t index)
+{
+    timer_TypeDef *last;
+
+    heap[index]->index = TIMER_INACTIVE;
+    heapCount--;
+    if (index == heapCount)
+    {
+        return;
+    }
+
+    last = heap[heapCount];
+    place(index, last);
+    siftDown(index);
+    siftUp(last->index);
+}
+
+/**
+  * @}
+  */
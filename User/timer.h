@@ -0,0 +1,39 @@
+#ifndef TIMER_H__
+#define TIMER_H__ 1
+
+#include <stdbool.h>
+#include "main.h"
+
+#define TIMER_MAX 8U             /*!< 동시에 동작 가능한 타이머 갯수 */
+#define TIMER_INACTIVE 0xFFU     /*!< 정지한 타이머의 힙 위치 */
+
+typedef struct timer timer_TypeDef;
+
+/**
+ * @brief 타이머 만료 콜백. Timer_Process() 에서 호출되므로 인터럽트가 아닌 사용자 Loop 에서 실행됨.
+ *        콜백 안에서 타이머 시작, 정지 가능.
+ *
+ * @param timer: 만료된 타이머
+ */
+typedef void (*timerCallback_TypeDef)(timer_TypeDef *timer);
+
+struct timer
+{
+    uint32_t deadline;              /*!< 만료 시각. HAL_GetTick() 기준 */
+    uint32_t interval;              /*!< 만료 간격. 단위 ms */
+    bool periodic;                  /*!< true 면 만료 후 같은 간격으로 다시 시작 */
+    uint8_t index;                  /*!< 힙 내 위치. TIMER_INACTIVE 면 정지 */
+    timerCallback_TypeDef callback; /*!< 만료 콜백 */
+};                                  /*!< 소프트웨어 타이머 */
+
+/* Extern functions ---------------------------------------------------------*/
+void Timer_Init(timer_TypeDef *timer, timerCallback_TypeDef callback);      /*!< 타이머 초기화. 정지 상태 */
+ErrorStatus Timer_Start(timer_TypeDef *timer, uint32_t interval, bool periodic); /*!< 지금부터 interval 후 만료 */
+ErrorStatus Timer_Restart(timer_TypeDef *timer);                             /*!< 마지막 간격으로 다시 시작 */
+void Timer_Stop(timer_TypeDef *timer);                                       /*!< 타이머 정지 */
+bool Timer_IsRunning(const timer_TypeDef *timer);                            /*!< 동작 중 여부 */
+uint32_t Timer_GetRemaining(const timer_TypeDef *timer);                     /*!< 만료까지 남은 시간 */
+void Timer_Process(void);                                                    /*!< 만료된 타이머 콜백 실행 */
+void Timer_ArmNext(void);                                                    /*!< 가장 가까운 만료 시각으로 알람 설정 */
+
+#endif /* TIMER_H__ */
@@ -12,6 +12,9 @@
 #include <stdio.h>
 #include <string.h>
 #include "uart.h"
+#include "rtc.h"
+#include "backup.h"
+#include "event.h"
 
 /** @defgroup UART UART 제어 함수
   * @brief UART 제어 및 링 버퍼
@@ -22,13 +25,23 @@
 uartFIFO_TypeDef uart1Buffer; /*!< UART1 링 버퍼 구조체 - LTE모뎀 */
 uartFIFO_TypeDef uart2Buffer; /*!< UART2 링 버퍼 구조체 - DEBUG */
 
+uartTx_TypeDef uart1Tx; /*!< UART1 송신 버퍼 - LTE모뎀 */
+uartTx_TypeDef uart2Tx; /*!< UART2 송신 버퍼 - DEBUG */
+
 message_TypeDef uart1Message; /*!< UART2 메시지 구조체 - LTE모뎀 */
 message_TypeDef uart2Message; /*!< UART4 메시지 구조체- DEBUG */
 
-uint8_t uartTimeOutCount = 0; /*!< UART1 (LTE 모뎀) 데이터 수신 시 10으로 셋팅. */
+static uartErrorCount_TypeDef uart1Error; /*!< LTE 모뎀 UART 에러 횟수. 백업 레지스터에 유지 */
+
 
 /* Private functions ---------------------------------------------------------*/
-static ErrorStatus putByteToBuffer(volatile uartFIFO_TypeDef *buffer, uint8_t ch); /*!< 버퍼에 1Byte 쓰기 */
+static void updateDMAIndex(uartFIFO_TypeDef *buffer, UART_HandleTypeDef *huart); /*!< DMA 수신 위치로 쓰기 인덱스 갱신 */
+static void initTx(uartTx_TypeDef *tx, UART_HandleTypeDef *huart);                        /*!< 송신 버퍼 초기화 */
+static void startTx(uartTx_TypeDef *tx);                                                  /*!< 채운 면 DMA 전송 시작 */
+static void countError(uint8_t *count);                                                   /*!< 에러 횟수 증가 */
+static void saveErrorCount(void);                                                         /*!< 에러 횟수 백업 레지스터에 저장 */
+static bool isRxPending(UART_HandleTypeDef *huart, uartFIFO_TypeDef *buffer);             /*!< 수신 중이거나 알리지 않은 수신 데이터 있음 */
+static void dropOverrun(uartFIFO_TypeDef *buffer);                                        /*!< DMA 가 덮어쓴 수신 데이터 버림 */
 
 /* printf IO 사용을 위한 설정 */
 #ifdef __GNUC__
@@ -38,7 +51,9 @@ static ErrorStatus putByteToBuffer(volatile uartFIFO_TypeDef *buffer, uint8_t ch
 #endif /* __GNUC__ */
 PUTCHAR_PROTOTYPE
 {
-  HAL_UART_Transmit(&huart2, (uint8_t *)&ch, 1, 0xFFFF);
+  uint8_t c = (uint8_t)ch;
+
+  (void)Uart_Write(&uart2Tx, &c, 1U); /* 버퍼가 가득 차면 버림 */
   return ch;
 }
 
@@ -50,9 +65,30 @@ void Uart_Init(void)
 {
   initBuffer(&uart1Buffer);
   initBuffer(&uart2Buffer);
+  initTx(&uart1Tx, &huart1);
+  initTx(&uart2Tx, &huart2);
+
+  uint32_t errors = HAL_RTCEx_BKUPRead(&hrtc, BKP_UART_ERROR); /* 스탠바이 전 에러 횟수 불러오기 */
+  uart1Error.overrun = (uint8_t)errors;
+  uart1Error.framing = (uint8_t)(errors >> 8);
+  uart1Error.noise = (uint8_t)(errors >> 16);
+  uart1Error.dma = (uint8_t)(errors >> 24);
 
-  (void)HAL_UART_Receive_DMA(&huart1, &uart1Buffer.rxCh, 1U);
-  (void)HAL_UART_Receive_DMA(&huart2, &uart2Buffer.rxCh, 1U);
+  /* LTE 모뎀: Stop 모드에서 시작 비트 검출로 깨어남 (커널 클럭 HSI16) */
+  UART_WakeUpTypeDef wakeUp = {0};
+  wakeUp.WakeUpEvent = UART_WAKEUP_ON_STARTBIT;
+  (void)HAL_UARTEx_StopModeWakeUpSourceConfig(&huart1, wakeUp);
+  __HAL_UART_ENABLE_IT(&huart1, UART_IT_WUF);
+
+  /* LTE 모뎀: 링 버퍼 전체를 Circular DMA 로 연속 수신, IDLE 인터럽트로 수신 묶음 구분 */
+  (void)HAL_UART_Receive_DMA(&huart1, uart1Buffer.buff, UART_BUFFER_SIZE);
+  __HAL_UART_CLEAR_IDLEFLAG(&huart1);
+  __HAL_UART_ENABLE_IT(&huart1, UART_IT_IDLE);
+
+  /* DEBUG: LTE 모뎀과 같은 방식으로 연속 수신 (패스스루 모드에서 바이트 손실 없음) */
+  (void)HAL_UART_Receive_DMA(&huart2, uart2Buffer.buff, UART_BUFFER_SIZE);
+  __HAL_UART_CLEAR_IDLEFLAG(&huart2);
+  __HAL_UART_ENABLE_IT(&huart2, UART_IT_IDLE);
 }
 
 /**
@@ -63,32 +99,407 @@ void Uart_Init(void)
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
 {
 
+  if (huart->Instance == USART1) /* LTE MODEM - 링 버퍼 끝 도달 */
+  {
+    updateDMAIndex(&uart1Buffer, huart);
+    Event_Post(EVENT_UART1_RX);
+  }
+  if (huart->Instance == USART2) /* DEBUG - 링 버퍼 끝 도달 */
+  {
+    updateDMAIndex(&uart2Buffer, huart);
+    Event_Post(EVENT_UART2_RX);
+  }
+}
+
+/**
+  * @brief  UART RX DMA 절반 수신 인터럽트
+  * 
+  * @param huart
+  */
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart)
+{
+  if (huart->Instance == USART1) /* LTE MODEM - 링 버퍼 절반 도달 */
+  {
+    updateDMAIndex(&uart1Buffer, huart);
+    Event_Post(EVENT_UART1_RX);
+  }
+  if (huart->Instance == USART2) /* DEBUG - 링 버퍼 절반 도달 */
+  {
+    updateDMAIndex(&uart2Buffer, huart);
+    Event_Post(EVENT_UART2_RX);
+  }
+}
+
+/**
+  * @brief  UART IDLE 인터럽트. USART1_IRQHandler() 에서 IDLE 플래그 검출 시 호출됨.
+  * @note   수신 라인이 1 프레임 이상 비어 있으면 모뎀의 응답 묶음 수신이 끝난 것으로 판단
+  * 
+  * @param huart
+  */
+void Uart_RxIdleCallback(UART_HandleTypeDef *huart)
+{
   if (huart->Instance == USART1) /* LTE MODEM */
   {
-    (void)putByteToBuffer(&uart1Buffer, uart1Buffer.rxCh);
-    (void)HAL_UART_Receive_DMA(huart, (uint8_t *)&uart1Buffer.rxCh, 1U);
-    uartTimeOutCount = 10;
+    updateDMAIndex(&uart1Buffer, huart);
+    Event_Post(EVENT_UART1_RX);
   }
   if (huart->Instance == USART2) /* DEBUG */
   {
-    (void)putByteToBuffer(&uart2Buffer, uart2Buffer.rxCh);
-    (void)HAL_UART_Receive_DMA(huart, (uint8_t *)&uart2Buffer.rxCh, 1U);
+    updateDMAIndex(&uart2Buffer, huart);
+    Event_Post(EVENT_UART2_RX);
   }
 }
 
 /**
- * @brief UART 에러 발생 인터럽트
+  * @brief  UART TX DMA 전송 완료 인터럽트. 그 사이 채워진 면이 있으면 이어서 전송
+  * 
+  * @param huart
+  */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+  uartTx_TypeDef *tx = (huart->Instance == USART1) ? &uart1Tx : &uart2Tx;
+
+  tx->busy = false;
+  startTx(tx);
+  Event_Post(EVENT_UART_TX);
+}
+
+/**
+  * @brief  UART 수신 에러 인터럽트. USART1_IRQHandler() 에서 HAL_UART_IRQHandler() 전에 호출됨.
+  * @note   HAL 은 DMA 수신 중 에러가 나면 DMA 를 중단하므로 여기서 플래그를 먼저 정리하고
+  *         횟수만 기록. 수신 DMA 는 멈추지 않고 에러 난 바이트만 잘못 수신됨.
+  * 
+  * @param huart
+  */
+void Uart_RxErrorCallback(UART_HandleTypeDef *huart)
+{
+  uint32_t isrflags = huart->Instance->ISR;
+
+  __HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_PEF | UART_CLEAR_FEF | UART_CLEAR_NEF | UART_CLEAR_OREF);
+  if (huart->Instance != USART1) /* LTE 모뎀만 기록 */
+  {
+    return;
+  }
+
+  if ((isrflags & USART_ISR_ORE) != 0U)
+  {
+    countError(&uart1Error.overrun);
+  }
+  if ((isrflags & USART_ISR_FE) != 0U)
+  {
+    countError(&uart1Error.framing);
+  }
+  if ((isrflags & (USART_ISR_NE | USART_ISR_PE)) != 0U)
+  {
+    countError(&uart1Error.noise);
+  }
+  saveErrorCount();
+}
+
+/**
+ * @brief UART 에러 발생 인터럽트. Uart_RxErrorCallback() 에서 처리하지 못한 DMA 에러 등.
  * 
  * @param huart 
  */
 void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
 {
-  if (huart->ErrorCode == HAL_UART_ERROR_ORE)
+  if (huart->Instance == USART1)
+  {
+    if ((huart->ErrorCode & HAL_UART_ERROR_DMA) != 0U)
+    {
+      countError(&uart1Error.dma);
+    }
+    if ((huart->ErrorCode & HAL_UART_ERROR_ORE) != 0U)
+    {
+      countError(&uart1Error.overrun);
+    }
+    saveErrorCount();
+  }
+
+  if (huart->RxState == HAL_UART_STATE_READY) /* 에러로 DMA 수신이 중단되었으면 재시작 */
+  {
+    uartFIFO_TypeDef *buffer = (huart->Instance == USART1) ? &uart1Buffer : &uart2Buffer;
+
+    Ring_Init(&buffer->ring, buffer->buff, UART_BUFFER_SIZE); /* DMA 가 버퍼 처음부터 다시 수신 */
+    buffer->scan = 0U;
+    (void)HAL_UART_Receive_DMA(huart, buffer->buff, UART_BUFFER_SIZE);
+  }
+
+  if (huart->gState == HAL_UART_STATE_READY) /* 에러로 DMA 송신이 중단되었으면 다음 면 전송 */
+  {
+    uartTx_TypeDef *tx = (huart->Instance == USART1) ? &uart1Tx : &uart2Tx;
+
+    if (tx->busy)
+    {
+      tx->busy = false;
+      startTx(tx);
+    }
+  }
+}
+
+/**
+ * @brief LTE 모뎀 UART 에러 횟수
+ * 
+ * @return const uartErrorCount_TypeDef*: 마지막 초기화 이후 에러 횟수
+ */
+const uartErrorCount_TypeDef *Uart_GetErrorCount(void)
+{
+  return &uart1Error;
+}
+
+/**
+ * @brief LTE 모뎀 UART 에러 횟수 초기화. 서버 전송 완료 후 호출.
+ * 
+ */
+void Uart_ClearErrorCount(void)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  memset(&uart1Error, 0, sizeof(uart1Error));
+  saveErrorCount();
+  __set_PRIMASK(primask);
+}
+
+/**
+ * @brief 에러 횟수 1 증가. 255 에서 멈춤.
+ * 
+ * @param count: 증가할 횟수
+ */
+static void countError(uint8_t *count)
+{
+  if (*count < UINT8_MAX)
+  {
+    (*count)++;
+  }
+}
+
+/**
+ * @brief 에러 횟수를 백업 레지스터에 저장. 스탠바이 후 다음 전송에 포함.
+ * 
+ */
+static void saveErrorCount(void)
+{
+  HAL_RTCEx_BKUPWrite(&hrtc, BKP_UART_ERROR, ((uint32_t)uart1Error.dma << 24) | ((uint32_t)uart1Error.noise << 16) |
+                                                 ((uint32_t)uart1Error.framing << 8) | uart1Error.overrun);
+}
+
+/**
+ * @brief 송신 버퍼 초기화
+ * 
+ * @param tx: 송신 버퍼 구조체 포인터
+ * @param huart: 송신 UART
+ */
+static void initTx(uartTx_TypeDef *tx, UART_HandleTypeDef *huart)
+{
+  tx->length[0] = 0U;
+  tx->length[1] = 0U;
+  tx->fill = 0U;
+  tx->busy = false;
+  tx->huart = huart;
+}
+
+/**
+ * @brief 채우는 중인 면을 DMA 로 전송하고 다른 면을 채우기 시작. 인터럽트 금지 상태 또는 인터럽트에서 호출.
+ * 
+ * @param tx: 송신 버퍼 구조체 포인터
+ */
+static void startTx(uartTx_TypeDef *tx)
+{
+  uint8_t send = tx->fill;
+
+  if (tx->busy || (tx->length[send] == 0U))
+  {
+    return;
+  }
+
+  if (HAL_UART_Transmit_DMA(tx->huart, tx->buff[send], tx->length[send]) == HAL_OK)
+  {
+    tx->busy = true;
+    tx->fill = send ^ 1U;
+    tx->length[tx->fill] = 0U;
+  }
+}
+
+/**
+ * @brief 송신 버퍼에 데이터를 쓰고 바로 반환. DMA 가 쉬고 있으면 전송 시작.
+ * @note  DMA 완료 인터럽트가 면을 바꾸므로 복사하는 동안 인터럽트 금지.
+ * 
+ * @param tx: 송신 버퍼 구조체 포인터
+ * @param data: 보낼 데이터
+ * @param length: 보낼 길이
+ * @return uint16_t: 버퍼에 쓴 길이. 남은 공간이 부족하면 length 보다 작음
+ */
+uint16_t Uart_Write(uartTx_TypeDef *tx, const uint8_t *data, uint16_t length)
+{
+  uint32_t primask = __get_PRIMASK();
+  uint8_t fill;
+  uint16_t used;
+
+  __disable_irq();
+  fill = tx->fill;
+  used = tx->length[fill];
+  if (length > (UART_TX_BUFFER_SIZE - used))
+  {
+    length = (uint16_t)(UART_TX_BUFFER_SIZE - used);
+  }
+  memcpy(&tx->buff[fill][used], data, length);
+  tx->length[fill] = (uint16_t)(used + length);
+  startTx(tx);
+  __set_PRIMASK(primask);
+
+  return length;
+}
+
+/**
+ * @brief 수신 버퍼의 데이터를 다른 UART 의 송신 버퍼로 전달. 복사 후 바로 반환.
+ * @note  송신 버퍼가 가득 차면 남은 데이터는 수신 버퍼에 두고 다음 호출에서 전달.
+ * 
+ * @param from: 수신 버퍼 구조체 포인터
+ * @param to: 송신 버퍼 구조체 포인터
+ */
+void Uart_Forward(uartFIFO_TypeDef *from, uartTx_TypeDef *to)
+{
+  const uint8_t *data;
+  uint16_t length;
+
+  dropOverrun(from);
+  while ((length = Ring_ReadSpan(&from->ring, &data)) != 0U) /* 링 버퍼 끝에서 나뉘면 2번 */
   {
-    /* Overrun error 처리 */
+    uint16_t written = Uart_Write(to, data, length);
+
+    Ring_Consume(&from->ring, written);
+    from->scan = from->ring.out;
+    if (written < length) /* 송신 버퍼가 가득 참 */
+    {
+      break;
+    }
   }
 }
 
+/**
+ * @brief 송신 버퍼에 바로 쓸 수 있는 길이
+ * 
+ * @param tx: 송신 버퍼 구조체 포인터
+ * @return uint16_t: 채우는 중인 면의 남은 공간
+ */
+uint16_t Uart_GetTxFree(uartTx_TypeDef *tx)
+{
+  return (uint16_t)(UART_TX_BUFFER_SIZE - tx->length[tx->fill]);
+}
+
+/**
+ * @brief 송신할 데이터가 모두 전송되었는지 확인
+ * 
+ * @param tx: 송신 버퍼 구조체 포인터
+ * @return true: 전송 완료
+ */
+bool Uart_IsTxIdle(uartTx_TypeDef *tx)
+{
+  return !tx->busy && (tx->length[tx->fill] == 0U);
+}
+
+/**
+ * @brief 통신 속도와 흐름 제어 변경. 수신, 송신 중인 데이터는 버리고 DMA 수신 재시작.
+ * @note  USART1 의 CTS 핀(PA11)은 PWR_RS232 로 사용하므로 흐름 제어는 RTS(PA12) 만 가능.
+ * 
+ * @param huart: 변경할 UART
+ * @param baudRate: 통신 속도
+ * @param hwFlowCtl: UART_HWCONTROL_NONE 또는 UART_HWCONTROL_RTS
+ * @return ErrorStatus: UART 설정 실패 시 ERROR
+ */
+ErrorStatus Uart_SetBaudRate(UART_HandleTypeDef *huart, uint32_t baudRate, uint32_t hwFlowCtl)
+{
+  uartFIFO_TypeDef *buffer = (huart->Instance == USART1) ? &uart1Buffer : &uart2Buffer;
+  uartTx_TypeDef *tx = (huart->Instance == USART1) ? &uart1Tx : &uart2Tx;
+
+  if ((huart->Instance == USART1) && (hwFlowCtl != UART_HWCONTROL_NONE)) /* PA12 ------> USART1_RTS */
+  {
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    GPIO_InitStruct.Pin = GPIO_PIN_12;
+    GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    GPIO_InitStruct.Alternate = GPIO_AF7_USART1;
+    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+  }
+
+  (void)HAL_UART_Abort(huart);
+  huart->Init.BaudRate = baudRate;
+  huart->Init.HwFlowCtl = hwFlowCtl;
+  huart->Init.OverSampling = (baudRate > 460800U) ? UART_OVERSAMPLING_8 : UART_OVERSAMPLING_16; /* 커널 클럭 16MHz, 32MHz 에서 오차 1% 이하 */
+  if (HAL_UART_Init(huart) != HAL_OK)
+  {
+    return ERROR;
+  }
+
+  initBuffer(buffer);
+  initTx(tx, huart);
+  (void)HAL_UART_Receive_DMA(huart, buffer->buff, UART_BUFFER_SIZE);
+  __HAL_UART_CLEAR_IDLEFLAG(huart);
+  __HAL_UART_ENABLE_IT(huart, UART_IT_IDLE);
+  return SUCCESS;
+}
+
+/**
+ * @brief LTE 모뎀 UART 를 Stop 1 모드에서 시작 비트로 깨어나도록 설정. 인터럽트 금지 상태에서 호출.
+ * @note  Stop 모드에서는 DMA 가 동작하지 않으므로 DMA 수신 요청을 끄고 UESM 을 켬. 시작 비트에서
+ *        깨어나면 Uart_ExitStopMode() 가 DMA 요청을 다시 켜고, 그 사이 RDR 에 받은 바이트는 DMA 가 가져감.
+ *        USART1/2 는 Stop 2 모드에서 깨울 수 없으므로 Stop 1 모드에서만 사용.
+ *
+ * @return ErrorStatus: 수신 중이거나 IDLE 로 알리지 않은 수신 데이터가 있으면 ERROR. 이때는 Stop 모드 진입 금지
+ */
+ErrorStatus Uart_EnterStopMode(void)
+{
+  if (isRxPending(&huart1, &uart1Buffer))
+  {
+    return ERROR;
+  }
+
+  SET_BIT(huart1.Instance->CR1, USART_CR1_UESM);
+  CLEAR_BIT(huart1.Instance->CR3, USART_CR3_DMAR);
+  if (huart1.Init.BaudRate > UART_STOP_HSI_BAUD_MAX) /* HSI16 기동 시간 동안 시작 비트를 놓칠 수 있음 */
+  {
+    __HAL_RCC_HSISTOP_ENABLE();
+  }
+
+  if (isRxPending(&huart1, &uart1Buffer)) /* 설정하는 사이 수신 시작 */
+  {
+    Uart_ExitStopMode();
+    return ERROR;
+  }
+  return SUCCESS;
+}
+
+/**
+ * @brief Stop 모드 해제 후 LTE 모뎀 UART DMA 수신 재개. 인터럽트 금지 상태에서 호출.
+ *
+ */
+void Uart_ExitStopMode(void)
+{
+  SET_BIT(huart1.Instance->CR3, USART_CR3_DMAR);
+  CLEAR_BIT(huart1.Instance->CR1, USART_CR1_UESM);
+  __HAL_RCC_HSISTOP_DISABLE();
+}
+
+/**
+ * @brief 수신 중인 바이트가 있거나, DMA 로 받았지만 IDLE 인터럽트로 알리지 않은 데이터가 있는지 확인.
+ * @note  수신이 끝나고 IDLE 검출 전에 Stop 모드로 들어가면 UART 클럭이 멈춰 IDLE 인터럽트가 발생하지 않음.
+ *
+ * @param huart: DMA 수신 중인 UART
+ * @param buffer: 수신 링 버퍼
+ * @return true: Stop 모드 진입 불가
+ */
+static bool isRxPending(UART_HandleTypeDef *huart, uartFIFO_TypeDef *buffer)
+{
+  uint16_t position = (uint16_t)((UART_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(huart->hdmarx)) & (UART_BUFFER_SIZE - 1U));
+
+  return (__HAL_UART_GET_FLAG(huart, UART_FLAG_BUSY) != RESET) ||
+         (__HAL_UART_GET_FLAG(huart, UART_FLAG_RXNE) != RESET) ||
+         (position != (buffer->ring.in & buffer->ring.mask));
+}
+
 /**
  * @brief UART 수신 버퍼 초기화
  * 
@@ -96,39 +507,51 @@ void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
  */
 void initBuffer(uartFIFO_TypeDef *buffer)
 {
-  buffer->count = 0U; /* 버퍼에 저장된 데이터 갯수 초기화 */
-  buffer->in = 0U;    /* 버퍼 시작 인덱스 초기화*/
-  buffer->out = 0U;   /* 버퍼 끝 인덱스 초기화 */
+  Ring_Init(&buffer->ring, buffer->buff, UART_BUFFER_SIZE);
+  buffer->scan = 0U; /* 줄 검사 인덱스 초기화 */
   memset(buffer->buff, 0, sizeof(buffer->buff));
 }
 
 /**
- * @brief 버퍼에 1byte 저장
+ * @brief 버퍼에 저장된 데이터 갯수
  * 
  * @param buffer: UART 버퍼 구조체 포인터
- * @param ch: 저장 할 Byte 데이터
+ * @return uint16_t: 읽지 않은 데이터 갯수
  */
-static ErrorStatus putByteToBuffer(volatile uartFIFO_TypeDef *buffer, uint8_t ch)
+uint16_t getBufferCount(uartFIFO_TypeDef *buffer)
 {
-  ErrorStatus status = ERROR;
+  return Ring_Count(&buffer->ring);
+}
 
-  if (buffer->count != UART_BUFFER_SIZE) /* 데이터가 버퍼에 가득 찼으면 ERROR 리턴 */
+/**
+ * @brief DMA 수신 위치로 버퍼 쓰기 인덱스 갱신. 인터럽트에서만 호출.
+ * 
+ * @param buffer: UART 버퍼 구조체 포인터
+ * @param huart: DMA 수신 중인 UART
+ */
+static void updateDMAIndex(uartFIFO_TypeDef *buffer, UART_HandleTypeDef *huart)
+{
+  if (!Ring_SyncDMA(&buffer->ring, (uint16_t)(UART_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(huart->hdmarx))) &&
+      (huart->Instance == USART1)) /* 읽기 전에 DMA 가 한 바퀴 돌아 덮어씀. LTE 모뎀만 기록 */
   {
-    buffer->buff[buffer->in] = ch; /* 버퍼에 1Byte 저장 */
-    buffer->in++;
-    buffer->count++;                    /* 버퍼에 저장된 갯수 1 증가 */
-    if (buffer->in == UART_BUFFER_SIZE) /* 시작 인덱스가 버퍼의 끝이면 */
-    {
-      buffer->in = 0U; /* 시작 인덱스를 0부터 다시 시작 */
-    }
-    status = SUCCESS;
+    countError(&uart1Error.overrun);
+    saveErrorCount();
   }
-  else
+}
+
+/**
+ * @brief DMA 가 읽지 않은 데이터를 덮어썼으면 저장된 데이터를 모두 버림.
+ *        덮어쓴 줄의 앞부분을 알 수 없으므로 다음 수신부터 다시 분리.
+ * 
+ * @param buffer: UART 버퍼 구조체 포인터
+ */
+static void dropOverrun(uartFIFO_TypeDef *buffer)
+{
+  if (Ring_IsOverrun(&buffer->ring))
   {
-    status = ERROR;
+    Ring_Consume(&buffer->ring, Ring_Count(&buffer->ring));
+    buffer->scan = buffer->ring.out;
   }
-
-  return status;
 }
 
 /**
@@ -139,29 +562,127 @@ static ErrorStatus putByteToBuffer(volatile uartFIFO_TypeDef *buffer, uint8_t ch
  * @return ErrorStatus: 버퍼에 데이터가 없으면 ERROR
  *         @arg SUCCESS, ERROR
  */
-ErrorStatus getByteFromBuffer(volatile uartFIFO_TypeDef *buffer, uint8_t *ch)
+ErrorStatus getByteFromBuffer(uartFIFO_TypeDef *buffer, uint8_t *ch)
 {
-  ErrorStatus status = ERROR;
+  dropOverrun(buffer);
+  if (!Ring_Get(&buffer->ring, ch))
+  {
+    return ERROR;
+  }
+  buffer->scan = buffer->ring.out;
+  return SUCCESS;
+}
 
-  if (buffer->count != 0U) /* 버퍼에 데이터가 있으면 */
+/**
+ * @brief 버퍼에서 \r\n 으로 끝나는 한 줄을 복사 없이 꺼냄
+ * @note  꺼낸 줄은 읽기 인덱스에서 제외되며, 링 버퍼가 한 바퀴 돌아 덮어쓰기 전까지 유효.
+ *        읽기 전에 DMA 가 덮어쓴 데이터는 버리고 다음 수신부터 분리.
+ *        빈 줄은 건너뛰고, 줄바꿈 없이 UART_LINE_MAX_SIZE 를 넘으면 그 길이까지를 한 줄로 처리.
+ *        검사 위치를 저장하므로 여러 번 나누어 수신된 줄도 다시 검사하지 않음.
+ * 
+ * @param buffer: UART 버퍼 구조체 포인터
+ * @param line: 꺼낸 줄 (링 버퍼 끝에서 나뉘면 2조각)
+ * @return ErrorStatus: 완성된 줄이 없으면 ERROR
+ *         @arg SUCCESS, ERROR
+ */
+ErrorStatus getLineFromBuffer(uartFIFO_TypeDef *buffer, uartLine_TypeDef *line)
+{
+  ring_TypeDef *ring = &buffer->ring;
+  uint16_t in, scan;
+  uint16_t start, length;
+
+  dropOverrun(buffer);
+  in = ring->in;
+  scan = buffer->scan;
+
+  while (1)
   {
+    bool found = false;
 
-    *ch = buffer->buff[buffer->out]; /* 버퍼에서 1Byte 읽음 */
-    //buffer->buff[buffer->out] = 0U;
-    buffer->out++;
-    buffer->count--;                     /* 버퍼에 저장된 데이터 갯수 1 감소 */
-    if (buffer->out == UART_BUFFER_SIZE) /* 끝 인덱스가 버퍼의 끝이면 */
+    while (scan != in)
     {
-      buffer->out = 0U; /* 끝 인덱스를 0부터 다시 시작 */
+      if (Ring_At(ring, scan++) == '\n')
+      {
+        found = true;
+        break;
+      }
+    }
+
+    start = ring->out;
+    length = (uint16_t)(scan - start);
+    buffer->scan = scan;
+
+    if (!found && (length < UART_LINE_MAX_SIZE)) /* 줄이 아직 완성되지 않음 */
+    {
+      return ERROR;
+    }
+
+    Ring_Consume(ring, length); /* 줄바꿈 문자까지 읽은 것으로 처리 */
+
+    while ((length != 0U) && ((Ring_At(ring, (uint16_t)(start + length - 1U)) == '\n') ||
+                              (Ring_At(ring, (uint16_t)(start + length - 1U)) == '\r')))
+    {
+      length--; /* 줄 끝의 \r\n 제거 */
+    }
+
+    if (length != 0U)
+    {
+      break;
+    }
+    if (!found) /* 남은 데이터 없음 */
+    {
+      return ERROR;
     }
-    status = SUCCESS;
+  }
+
+  start &= ring->mask;
+  line->data[0] = &buffer->buff[start];
+  if ((start + length) > UART_BUFFER_SIZE) /* 링 버퍼 끝에서 나뉜 줄 */
+  {
+    line->length[0] = (uint16_t)(UART_BUFFER_SIZE - start);
+    line->data[1] = &buffer->buff[0];
+    line->length[1] = (uint16_t)(length - line->length[0]);
   }
   else
   {
-    status = ERROR;
+    line->length[0] = length;
+    line->data[1] = NULL;
+    line->length[1] = 0U;
   }
 
-  return status;
+  return SUCCESS;
+}
+
+/**
+ * @brief 줄 전체 길이
+ * 
+ * @param line: 줄 구조체 포인터
+ * @return uint16_t: 두 조각을 합친 길이
+ */
+uint16_t getLineLength(const uartLine_TypeDef *line)
+{
+  return (uint16_t)(line->length[0] + line->length[1]);
+}
+
+/**
+ * @brief 줄의 index 번째 문자
+ * 
+ * @param line: 줄 구조체 포인터
+ * @param index: 0 부터 getLineLength() - 1 까지
+ * @return uint8_t: 문자. 범위를 벗어나면 0
+ */
+uint8_t getLineChar(const uartLine_TypeDef *line, uint16_t index)
+{
+  if (index < line->length[0])
+  {
+    return line->data[0][index];
+  }
+  index -= line->length[0];
+  if (index < line->length[1])
+  {
+    return line->data[1][index];
+  }
+  return 0U;
 }
 
 /**
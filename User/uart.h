@@ -1,10 +1,15 @@
 #ifndef UART_H__
 #define UART_H__ 1
 
+#include <stdbool.h>
 #include "main.h"
 #include "usart.h"
+#include "ring.h"
 
-#define UART_BUFFER_SIZE 600U
+#define UART_BUFFER_SIZE 1024U /*!< 수신 링 버퍼 크기. 2의 거듭제곱 */
+#define UART_LINE_MAX_SIZE (UART_BUFFER_SIZE / 2U) /*!< 줄바꿈 없이 이 길이를 넘으면 한 줄로 처리 */
+#define UART_TX_BUFFER_SIZE 640U /*!< 송신 버퍼 한 면의 크기. WHTTP DATA 한 줄(소요 시간 통계 포함) 이상 */
+#define UART_STOP_HSI_BAUD_MAX 115200U /*!< 이 속도를 넘으면 Stop 모드에서도 HSI16 을 켜 두어 첫 바이트 수신 보장 */
 #define MESSAGE_MAX_SIZE 300U
 
 #define MESSAGE_STX 0x02U
@@ -27,14 +32,34 @@ typedef enum
 
 typedef struct
 {
-    uint16_t in;
-    uint16_t out;
-    uint16_t count;
+    ring_TypeDef ring; /*!< 생산자: DMA (인터럽트에서 DMA 카운터로 in 갱신), 소비자: 사용자 Loop */
+    uint16_t scan;     /*!< 줄 단위 분리 시 다음에 검사할 인덱스. out 이상 in 이하 */
     uint8_t buff[UART_BUFFER_SIZE];
-    uint8_t rxCh;
-    uint8_t buffCh;
 } uartFIFO_TypeDef; /*!< 수신 패킷 저장 버퍼 구조체 */
 
+typedef struct
+{
+    uint8_t buff[2][UART_TX_BUFFER_SIZE]; /*!< 송신 버퍼 2면. 한 면을 DMA 로 보내는 동안 다른 면에 채움 */
+    volatile uint16_t length[2];          /*!< 각 면에 채워진 길이 */
+    volatile uint8_t fill;                /*!< 채우는 중인 면 */
+    volatile bool busy;                   /*!< DMA 전송 중 */
+    UART_HandleTypeDef *huart;            /*!< 송신 UART */
+} uartTx_TypeDef;                         /*!< DMA 송신 이중 버퍼 구조체 */
+
+typedef struct
+{
+    uint8_t overrun; /*!< ORE. 수신 데이터를 DMA 가 가져가기 전에 다음 데이터 수신. 읽기 전에 DMA 가 링 버퍼를 덮어쓴 경우 포함 */
+    uint8_t framing; /*!< FE. 정지 비트 오류 (통신 속도 불일치 등) */
+    uint8_t noise;   /*!< NE, PE. 샘플링 잡음 */
+    uint8_t dma;     /*!< DMA 전송 에러 */
+} uartErrorCount_TypeDef; /*!< UART 에러 횟수. 각 255 에서 멈춤 */
+
+typedef struct
+{
+    const uint8_t *data[2]; /*!< 링 버퍼 내 줄 시작 위치. 버퍼 끝에서 나뉘면 data[1] 에 나머지 */
+    uint16_t length[2];     /*!< 각 조각의 길이. 줄바꿈 문자 제외 */
+} uartLine_TypeDef;         /*!< 링 버퍼 위의 한 줄 (복사 없음) */
+
 typedef struct
 {
     MessageStage lastStage;
@@ -51,14 +76,30 @@ typedef struct
 extern uartFIFO_TypeDef uart1Buffer; /*!< UART1 링 버퍼 구조체 - RS232 */
 extern uartFIFO_TypeDef uart2Buffer; /*!< UART2 링 버퍼 구조체 - RS485 */
 
+extern uartTx_TypeDef uart1Tx; /*!< UART1 송신 버퍼 - LTE모뎀 */
+extern uartTx_TypeDef uart2Tx; /*!< UART2 송신 버퍼 - DEBUG */
+
 extern message_TypeDef uart1Message; /*!< UART2 메시지 구조체 - RS485 */
 extern message_TypeDef uart2Message; /*!< UART4 메시지 구조체- Raspberry Pi */
 
-extern uint8_t uartTimeOutCount;
-
 /* Extern functions ---------------------------------------------------------*/
 void Uart_Init(void);                                                          /*!< UART 관련 설정 초기화 */
-ErrorStatus getByteFromBuffer(volatile uartFIFO_TypeDef *buffer, uint8_t *ch); /*!< 버퍼에서 1Byte 읽기 */
+ErrorStatus getByteFromBuffer(uartFIFO_TypeDef *buffer, uint8_t *ch);          /*!< 버퍼에서 1Byte 읽기 */
 void initBuffer(uartFIFO_TypeDef *buffer);
+uint16_t getBufferCount(uartFIFO_TypeDef *buffer);                           /*!< 버퍼에 저장된 데이터 갯수 */
+ErrorStatus getLineFromBuffer(uartFIFO_TypeDef *buffer, uartLine_TypeDef *line); /*!< 버퍼에서 한 줄 꺼내기 */
+uint16_t getLineLength(const uartLine_TypeDef *line);                          /*!< 줄 전체 길이 */
+uint8_t getLineChar(const uartLine_TypeDef *line, uint16_t index);             /*!< 줄의 index 번째 문자 */
+void Uart_RxIdleCallback(UART_HandleTypeDef *huart);                           /*!< UART IDLE 인터럽트 */
+void Uart_RxErrorCallback(UART_HandleTypeDef *huart);                          /*!< UART 수신 에러 인터럽트 */
+const uartErrorCount_TypeDef *Uart_GetErrorCount(void);                        /*!< LTE 모뎀 UART 에러 횟수 */
+void Uart_ClearErrorCount(void);                                               /*!< LTE 모뎀 UART 에러 횟수 초기화 */
+uint16_t Uart_Write(uartTx_TypeDef *tx, const uint8_t *data, uint16_t length); /*!< 송신 버퍼에 쓰고 바로 반환 */
+uint16_t Uart_GetTxFree(uartTx_TypeDef *tx);                                   /*!< 송신 버퍼 남은 공간 */
+bool Uart_IsTxIdle(uartTx_TypeDef *tx);                                        /*!< 송신 완료 여부 */
+void Uart_Forward(uartFIFO_TypeDef *from, uartTx_TypeDef *to);                 /*!< 수신 버퍼를 송신 버퍼로 전달 */
+ErrorStatus Uart_SetBaudRate(UART_HandleTypeDef *huart, uint32_t baudRate, uint32_t hwFlowCtl); /*!< 통신 속도, 흐름 제어 변경 */
+ErrorStatus Uart_EnterStopMode(void);                                          /*!< LTE 모뎀 UART 를 Stop 모드 깨우기로 설정 */
+void Uart_ExitStopMode(void);                                                  /*!< Stop 모드 해제 후 DMA 수신 재개 */
 
 #endif /* UART_H__ */
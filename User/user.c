@@ -28,60 +28,171 @@
 #include "rtc.h"
 #include "user.h"
 #include "uart.h"
-#include "tim.h"
+#include "modem.h"
+#include "log.h"
+#include "link.h"
+#include "backup.h"
+#include "event.h"
+#include "power.h"
+#include "timebase.h"
+#include "timer.h"
+#include "stage.h"
+#include "profile.h"
+#include "energy.h"
+#include "retry.h"
 #include "adc.h"
-
-#define WAKEUP_INTERVAL 600   /*!< 센싱 주기 단위: 초 */
-#define SENSING_TIMES 6       /*!< 센싱 정보 저장 횟수 최대 10개 */
-#define OPMODE_TIMEOUT 2      /*!< 단위: 초 */
-#define RETRANSMISSIONS_CNT 2 /*!< 재전송 횟수 */
-
-//#define DEBUG_PRINT(...) printf(__VA_ARGS__) /* 디버깅 용 */
-#define DEBUG_PRINT(...)
+#include "pt.h"
+#include "flashlog.h"
+#include "pack.h"
+#include "retain.h"
+#include "config.h"
+
+#define PASSTHROUGH_HOLD_TIME 3000 /*!< 부팅 시 사용자 버튼을 이 시간 이상 누르면 패스스루 모드. 단위: ms */
+#define POWEROFF_HOLD_TIME 20000   /*!< 부팅 시 사용자 버튼을 눌렀으면 POWEROFF 모드에서 이 시간 후 스탠바이. 단위: ms */
+#define LED_BLINK_TIME 1000        /*!< LED 토글 주기. 단위: ms */
+#define SENDING_BACKOFF 5000       /*!< 서버 전송 실패 후 재시도 전 대기 시간. 단위: ms */
+#define ADC_TIMEOUT 1000           /*!< ADC 변환 제한 시간. 단위: ms */
+#define UPLOAD_DRAIN_MAX (CONFIG_BATCH_MAX - 1) /*!< 밀린 센싱 값을 한 번 깨어났을 때 이어서 전송하는 최대 횟수. 첫 전송 + 이 값 = 설정 uploadBatch 최대값 */
+#define FLUSH_CHUNK 16             /*!< 백업 레지스터에서 플래시 로그로 한 번에 옮기는 센싱 값 갯수 */
+#define CONFIG_COMMAND "CFG"       /*!< DEBUG 포트 설정 명령. "CFG?" 조회, "CFG=<Config_Parse() 형식>" 저장 후 적용 */
+#define CONFIG_COMMAND_MAX (CONFIG_URL_MAX + 40U) /*!< 설정 명령 한 줄 최대 길이 */
 
 typedef enum
 {
     BOOTING = 0,
     STANDBY,
-    POWERUP,
-    RUNNING,
-    POWERDOWN,
     POWEROFF,
     SENSING,
-    CHECKUSIM,
     SENDING,
     ACKCHECKING,
     WAITING,
-    CHECKINGIP,
-    CHECKINGNETWORKING,
-    WHTTP_POST,
-    WHTTP_HEAD,
-    WHTTP_DATA,
-    WHTTP_SEND,
-    TIMEOUT
-} OperatingStage; /*!< 운용모드 */
+    TIMEOUT,
+    PASSTHROUGH,
+    OPMODE_COUNT
+} OperatingStage; /*!< 운용모드. stageTable 순서 */
 
 bool flag_UserBtnOn = false;        /*!< 사용자 버튼 누름 상태 */
-bool flag_1SecTimerOn = false;      /*!< 1초 플래그 */
-bool flag_1mSecTimerOn = false;     /*!< 1m초 플래그 */
-bool flag_UartInterruptEnd = false; /*!< LTE 모뎀의 UART 수신 완료 */
-bool flag_OpmodeTimeout = false;    /*!< WAIT 모드에서 Timeout 플래그 */
 
-bool falg_Answer = false;
-static OperatingStage OPMode, OPModeNext, OPModeLast;
+static timer_TypeDef ledTimer;      /*!< LED 토글 주기 */
 
 uint32_t sendingCount = 0;  /*!< 전송 횟수 */
-uint16_t sensingCount = 0;  /*!< 디바이스 센싱 횟수. SENSING_TIMES 설정 값이 최대 */
+uint16_t sensingCount = 0;  /*!< 전송하지 않은 센싱 횟수 */
 uint16_t sendFailCount = 0; /*!< 전송 실패 횟수 */
 
 uint16_t ADCValue[3]; /*!< ADC 값. [0] BAT, [1] DEVICE, [2] REFENCE 3.3V */
 
+static uint32_t wakeupInterval;                /*!< 센싱 주기. 단위 초 (설정 wakeupInterval) */
+static uint16_t sensingTimes;                  /*!< 한 번에 전송하는 센싱 횟수 (설정 sensingTimes) */
+static uint16_t uploadBatch;                   /*!< LTE 모뎀을 한 번 켤 때 전송하는 횟수 (설정 uploadBatch) */
+static char urlCommand[CONFIG_URL_MAX + 20U]; /*!< AT*WHTTP=0,POST,<설정 url> */
+
 void enterStandByMode(uint32_t delaySec);
-void ParsingAckMessage(void);
-void saveSensingData(uint8_t cntSensing, uint32_t *Vdevice, uint32_t *Vbat, uint8_t Din);
-void loadSensingData(uint8_t cntSensing, uint32_t *Vdevice, uint32_t *Vbat, uint8_t *Din);
+void buildUploadData(void);
 uint8_t readDINValue(void);
 
+static bool isSimReady(const atResponse_TypeDef *response);
+static bool isRegistered(const atResponse_TypeDef *response);
+static bool isHttpStarted(const atResponse_TypeDef *response);
+static bool isHttpCompleted(const atResponse_TypeDef *response);
+static bool isHttpAccepted(const atResponse_TypeDef *response);
+static bool checkUploadStep(uint8_t step);
+static PT_THREAD(uploadThread(struct pt *pt));
+static void onLedTimer(timer_TypeDef *timer);
+
+static void enterBooting(void);
+static void enterStandby(void);
+static void enterPowerOff(void);
+static void enterSensing(void);
+static void enterSending(void);
+static void exitSending(void);
+static void processSending(void);
+static void enterAckChecking(void);
+static void enterTimeout(void);
+static void enterPassthrough(void);
+static void processPassthrough(void);
+static void processDebugPort(void);
+static void handleConfigCommand(const uartLine_TypeDef *line);
+static void flushSamples(void);
+static void applyConfig(void);
+
+typedef struct
+{
+    char data[UART_TX_BUFFER_SIZE]; /*!< 서버에 사용자 데이터 전송을 위한 버퍼 (AT*WHTTP=2,DATA) */
+    uint32_t firstSeq;              /*!< data 에 담은 첫 센싱 값의 플래시 로그 순번 */
+    uint16_t count;                 /*!< data 에 담은 센싱 값 갯수. 0 이면 전송 중인 값 없음 */
+} uploadSession_TypeDef;            /*!< 재전송을 위해 스탠바이 후에도 유지하는 전송 상태. 서버가 받을 때까지 플래시 로그에 남김 */
+
+static uploadSession_TypeDef session RETAINED; /*!< SRAM2 보관 영역 RETAIN_SESSION */
+static uint8_t drainCount;                                                         /*!< 이번 깨어남에서 이어서 전송한 횟수 */
+
+typedef enum
+{
+    UPLOAD_ECHO = 0,  /*!< ATE0 */
+    UPLOAD_SIM,       /*!< AT*CPIN? */
+    UPLOAD_REGISTER,  /*!< AT+CEREG? */
+    UPLOAD_ADDRESS,   /*!< AT*WWANIP? */
+    UPLOAD_URL,       /*!< AT*WHTTP=0. 이후 명령은 LTE 모뎀의 HTTP 설정을 이어서 사용하므로 실패하면 여기부터 재전송 */
+    UPLOAD_HEADER,    /*!< AT*WHTTP=2,HEAD */
+    UPLOAD_DATA,      /*!< AT*WHTTP=2,DATA */
+    UPLOAD_SEND,      /*!< AT*WHTTP=3 */
+    UPLOAD_COMPLETE,  /*!< 전송 완료 응답 대기 */
+    UPLOAD_STEP_COUNT
+} uploadStep; /*!< 서버 전송 단계. uploadScript 순서 */
+
+/**
+ * @brief 서버 전송 AT 명령. uploadStep 순서. uploadThread() 에서 하나씩 보내고 완료를 기다림.
+ *        재전송 횟수는 applyConfig() 에서 설정 retransmissions 로 채움.
+ */
+static modemCommand_TypeDef uploadScript[UPLOAD_STEP_COUNT] = {
+    {"ATE0\r\n", 0, AT_RSP_OK, 500, 0, NULL, NULL}, /* LTE 모뎀의 UART ECHO OFF */
+    {"AT*CPIN?\r\n", 0, AT_RSP_CPIN, 1000, 0, isSimReady, NULL},
+    {"AT+CEREG?\r\n", 0, AT_RSP_CEREG, 1000, 0, isRegistered, NULL},
+    {"AT*WWANIP?\r\n", 0, AT_RSP_WWANIP, 2000, 0, NULL, NULL},
+    {urlCommand, 0, AT_RSP_OK, 1000, 0, NULL, NULL},
+    {"AT*WHTTP=2,HEAD,Content-Type: application/x-www-form-urlencoded\r\n", 0, AT_RSP_OK, 1000, 0, NULL, NULL},
+    {session.data, 0, AT_RSP_OK, 2000, 0, NULL, NULL},
+    {"AT*WHTTP=3\r\n", 0, AT_RSP_WHTTPR, 10000, 0, isHttpStarted, NULL},
+    {NULL, 0, AT_RSP_WHTTPR, 30000, 0, isHttpCompleted, NULL}
+};
+
+static struct pt uploadPt;             /*!< 서버 전송 코루틴 */
+static struct pt linkPt;               /*!< 링크 설정 코루틴 */
+static modemWait_TypeDef uploadWait;   /*!< 서버 전송 AT 명령 결과 */
+
+/**
+ * @brief 서버 전송 코루틴에서 한 단계를 보내고 완료 대기. 재전송 시작 단계 이전이면 건너뛰고,
+ *        실패하면 코루틴 종료.
+ */
+#define UPLOAD_STEP(pt, step)                                    \
+    do                                                           \
+    {                                                            \
+        if ((step) >= Retry_GetStep())                           \
+        {                                                        \
+            MODEM_AWAIT((pt), &uploadWait, &uploadScript[step]); \
+            if (!checkUploadStep(step))                          \
+            {                                                    \
+                PT_EXIT(pt);                                     \
+            }                                                    \
+        }                                                        \
+    } while (0)
+
+/**
+ * @brief 운용모드 표. OperatingStage 순서.
+ *        {진입, 종료, 매 Loop, 제한 시간, 재시도 횟수, 재시도 간격, 실패 시 운용모드}
+ *        SENDING 의 제한 시간, 재시도 횟수는 applyConfig() 에서 설정으로 채움.
+ */
+static stage_TypeDef stageTable[OPMODE_COUNT] = {
+    {enterBooting, NULL, NULL, 0, 0, 0, TIMEOUT},                                                 /* BOOTING */
+    {enterStandby, NULL, NULL, 0, 0, 0, STANDBY},                                                 /* STANDBY */
+    {enterPowerOff, NULL, NULL, POWEROFF_HOLD_TIME, 0, 0, STANDBY},                               /* POWEROFF: 사용자 버튼으로 깨어 있는 시간 */
+    {enterSensing, NULL, NULL, 0, 0, 0, POWEROFF},                                                /* SENSING */
+    {enterSending, exitSending, processSending, 0, 0, SENDING_BACKOFF, TIMEOUT},                  /* SENDING */
+    {enterAckChecking, NULL, NULL, 0, 0, 0, POWEROFF},                                            /* ACKCHECKING */
+    {NULL, NULL, NULL, ADC_TIMEOUT, 0, 0, POWEROFF},                                              /* WAITING: ADC 완료 대기 */
+    {enterTimeout, NULL, NULL, 0, 0, 0, POWEROFF},                                                /* TIMEOUT */
+    {enterPassthrough, NULL, processPassthrough, 0, 0, 0, PASSTHROUGH}                            /* PASSTHROUGH */
+};
+
 /**
  * @brief 사용자 시작 함수 - 시작시 1회 수행
  *
@@ -91,24 +202,64 @@ void userStart(void)
     HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin);                          /* LED ON */
     HAL_GPIO_WritePin(PWR_RS232_GPIO_Port, PWR_RS232_Pin, GPIO_PIN_SET); /* MAX3232 전원 ON */
 
-    Uart_Init();                   /* UART 초기화 */
-    HAL_TIM_Base_Start_IT(&htim6); /* 1ms 타이머 인터럽트 시작 */
-    DEBUG_PRINT("\r\nSTART APPLICATION\r\n");
-
-    sendingCount = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR30);                   /* 전송 횟수 불러오기 */
-    sensingCount = HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR31) & 0xFFFF;          /* 센싱 횟수 불러오기 */
-    sendFailCount = (HAL_RTCEx_BKUPRead(&hrtc, RTC_BKP_DR31) >> 16) & 0xFFFF; /* 전송 실패 횟수 불러오기 */
-    DEBUG_PRINT("sensingCount : %d, sendingCount : %d, sendFailCount : %d\r\n", sensingCount, sendingCount, sendFailCount);
+    Log_Init();      /* 로그 링 버퍼 초기화 */
+    Timebase_Init(); /* LPTIM1 시간 기준 시작. 이후 1ms 주기 인터럽트 없음 */
+    Uart_Init();     /* UART 초기화 */
+    Link_Init();     /* LTE 모뎀 통신 속도 적용 */
+    Modem_Init();    /* AT 명령 엔진 초기화 */
+    Config_Init();   /* 플래시 설정 선택 */
+    applyConfig();   /* 센싱 주기, 전송 횟수, 서버 주소 적용 */
+    Retain_Init();   /* SRAM2 보관 영역 확인. 보관 영역을 쓰는 모듈보다 먼저 */
+    Profile_Init();  /* 소요 시간 측정 시작 */
+    Energy_Init();   /* 배터리 소모량 계산 이어서 시작 */
+    Retry_Init();    /* 지난 전송 실패 시 재전송 상태 불러오기 */
+    FlashLog_Init(); /* 전송하지 않은 센싱 값 찾기 */
+    Pack_Init();     /* 백업 레지스터에 모아 둔 센싱 값 확인 */
+    Stage_Init(stageTable, OPMODE_COUNT);
+    Timer_Init(&ledTimer, onLedTimer);
+    (void)Timer_Start(&ledTimer, LED_BLINK_TIME, true);
+    LOG_INFO("start application");
+
+    sendingCount = HAL_RTCEx_BKUPRead(&hrtc, BKP_SENDING);                   /* 전송 횟수 불러오기 */
+    sensingCount = (uint16_t)(FlashLog_GetPending() + Pack_GetCount());    /* 전송하지 않은 센싱 횟수 */
+    sendFailCount = (HAL_RTCEx_BKUPRead(&hrtc, BKP_COUNT) >> 16) & 0xFFFF; /* 전송 실패 횟수 불러오기 */
+    LOG_INFO("sensingCount: %u, sendingCount: %u, sendFailCount: %u", sensingCount, sendingCount, sendFailCount);
+
+    if (!Retain_Attach(RETAIN_SESSION, &session, sizeof(session)) && Retry_IsPending()) /* SRAM2 내용이 유지되지 않음 */
+    {
+        LOG_WARN("retry: upload data lost");
+        Retry_Clear();
+    }
 
     if (HAL_GPIO_ReadPin(USER_BTN_GPIO_Port, USER_BTN_Pin) == GPIO_PIN_RESET) /* 사용자 버튼 누름상태 체크 */
     {
         flag_UserBtnOn = true;
+
+        uint32_t tickstart = HAL_GetTick();
+        while ((HAL_GPIO_ReadPin(USER_BTN_GPIO_Port, USER_BTN_Pin) == GPIO_PIN_RESET) && ((HAL_GetTick() - tickstart) < PASSTHROUGH_HOLD_TIME))
+        {
+        }
+        if (HAL_GPIO_ReadPin(USER_BTN_GPIO_Port, USER_BTN_Pin) == GPIO_PIN_RESET) /* 계속 누르고 있으면 패스스루 모드 */
+        {
+            HAL_GPIO_WritePin(LTE_WAKEUP_GPIO_Port, LTE_WAKEUP_Pin, GPIO_PIN_SET);
+            Energy_SetLoad(ENERGY_LOAD_MODEM, true);
+            (void)Uart_SetBaudRate(&huart2, Link_GetBaudRate(), UART_HWCONTROL_NONE); /* DEBUG 포트도 LTE 모뎀과 같은 속도 */
+            Stage_Set(PASSTHROUGH);
+            return;
+        }
+    }
+
+    if (!Retry_IsSensingDue()) /* 재전송만 하려고 일찍 깨어남. 센싱 없이 전송 */
+    {
+        Stage_Set(BOOTING);
+        return;
     }
 
-    OPMode = WAITING;
+    Stage_Set(WAITING);
 
     HAL_GPIO_WritePin(PWR_BATCHECK_GPIO_Port, PWR_BATCHECK_Pin, GPIO_PIN_SET); /* 배터리 체크를 위한 전압 입력 ON */
     HAL_GPIO_WritePin(PWR_12V_GPIO_Port, PWR_12V_Pin, GPIO_PIN_SET);           /* 외부 디바이스 전력 공급 ON */
+    Energy_SetLoad(ENERGY_LOAD_12V, true);
 
     HAL_ADCEx_Calibration_Start(&hadc1, ADC_SINGLE_ENDED); /* ADC Calibration */
     HAL_Delay(1);
@@ -121,160 +272,286 @@ void userStart(void)
  */
 void userLoop(void)
 {
-    if (flag_1SecTimerOn) /* 1초 주기마다 실행 */
-    {
-        flag_1SecTimerOn = false;
-        HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin); /* LED 토글 */
-    }
-
-    if (flag_UartInterruptEnd) /* LTE 모뎀의 수신 데이터가 있으면 메시지 분석*/
-    {
-        flag_UartInterruptEnd = false;
-        ParsingAckMessage();
-    }
-
-    /* DEBUG 포트 입력 데이터를 LTE UART 포트로 전송 UART1:LTE모뎀, UART2:DEBUG - 디버그용 */
-    if (getByteFromBuffer(&uart2Buffer, &uart2Buffer.buffCh) == SUCCESS) /* UART2 버퍼에 데이터가 있으면 */
-    {
-        HAL_UART_Transmit(&huart1, (uint8_t *)&uart2Buffer.buffCh, 1, 0xFFFF); /* UART1로 데이터 전송 */
-        //HAL_UART_Transmit(&huart2, (uint8_t *)&uart2Buffer.buffCh, 1, 0xFFFF);
-    }
-
-    char *tmpTxData;                         /*!< LTE모뎀으로 전송을 위한 데이터 버퍼 */
-    char arrTxBuffer[300];                   /*!< 서버에 사용자 데이터 전송을 위한 버퍼 */
-    int tmpTxDataLength;                     /*!< 사용자 데이터 길이 저장용 */
-    static int resendCount = 0;              /*!< 재전송 횟수 */
-    uint8_t DINValue[SENSING_TIMES];         /*!< 서버에 보낼 때 데이터 저장용 */
-    float ADCVoltageValue[SENSING_TIMES][2]; /*!< 서버에 보낼 때 데이터 저장용 */
-    float VoltageBAT, VoltageDevice;
-
-    switch (OPMode)
-    {
-    case BOOTING:
-        HAL_GPIO_WritePin(LTE_WAKEUP_GPIO_Port, LTE_WAKEUP_Pin, GPIO_PIN_SET);
-        HAL_Delay(100);
-        char *tmpData = "ATE0\r\n"; /* LTE 모뎀의 UART ECHO OFF */
-        HAL_UART_Transmit(&huart1, (uint8_t *)tmpData, strlen(tmpData), 0xFFFF);
-
-        tmpTxData = "AT*CPIN?\r\n\0";
-        HAL_UART_Transmit(&huart1, (uint8_t *)tmpTxData, strlen(tmpTxData), 0xFFFF);
-        OPModeLast = OPMode;
-        OPModeNext = CHECKINGNETWORKING;
-        OPMode = WAITING;
-        break;
-    case CHECKINGNETWORKING:
-        tmpTxData = "AT+CEREG?\r\n\0";
-        HAL_UART_Transmit(&huart1, (uint8_t *)tmpTxData, strlen(tmpTxData), 0xFFFF);
-        OPModeLast = OPMode;
-        OPModeNext = CHECKINGIP;
-        OPMode = WAITING;
-        break;
-    case CHECKINGIP:
-        tmpTxData = "AT*WWANIP?\r\n\0";
-        HAL_UART_Transmit(&huart1, (uint8_t *)tmpTxData, strlen(tmpTxData), 0xFFFF);
-        OPModeLast = OPMode;
-        OPModeNext = WHTTP_POST;
-        OPMode = WAITING;
-        break;
-    case WHTTP_POST:
-        tmpTxData = "AT*WHTTP=0,POST,dbos.co.kr/smlf_api_v_2_1/test/set\r\n\0";
-        HAL_UART_Transmit(&huart1, (uint8_t *)tmpTxData, strlen(tmpTxData), 0xFFFF);
-        OPModeLast = OPMode;
-        OPModeNext = WHTTP_HEAD;
-        OPMode = WAITING;
-        break;
-    case WHTTP_HEAD:
-        tmpTxData = "AT*WHTTP=2,HEAD,Content-Type: application/x-www-form-urlencoded\r\n\0";
-        HAL_UART_Transmit(&huart1, (uint8_t *)tmpTxData, strlen(tmpTxData), 0xFFFF);
-        OPModeLast = OPMode;
-        OPModeNext = WHTTP_DATA;
-        OPMode = WAITING;
-        break;
-    case WHTTP_DATA:
-        for (int i = 0; i < SENSING_TIMES; i++)
-        {
-            loadSensingData(i, (uint32_t *)&ADCVoltageValue[i][0], (uint32_t *)&ADCVoltageValue[i][1], &DINValue[i]);
-        }
-        tmpTxDataLength = sprintf(arrTxBuffer, "AT*WHTTP=2,DATA,send=%ld\\&Fail=%d\\&V1=%.2f\\&V2=%.2f\\&V3=%.2f\\&V4=%.2f\\&V5=%.2f\\&V6=%.2f\\&B1=%.2f\\&B2=%.2f\\&B3=%.2f\\&B4=%.2f\\&B5=%.2f\\&B6=%.2f\\&D1=0x%x\\&D2=0x%x\\&D3=0x%x\\&D4=0x%x\\&D5=0x%x\\&D6=0x%x\r\n", sendingCount, sendFailCount, ADCVoltageValue[0][0], ADCVoltageValue[1][0], ADCVoltageValue[2][0], ADCVoltageValue[3][0], ADCVoltageValue[4][0], ADCVoltageValue[5][0], ADCVoltageValue[0][1], ADCVoltageValue[1][1], ADCVoltageValue[2][1], ADCVoltageValue[3][1], ADCVoltageValue[4][1], ADCVoltageValue[5][1], DINValue[0], DINValue[1], DINValue[2], DINValue[3], DINValue[4], DINValue[5]);
-        HAL_UART_Transmit(&huart1, (uint8_t *)arrTxBuffer, (uint16_t)tmpTxDataLength, 0xFFFF);
-        OPModeLast = OPMode;
-        OPModeNext = WHTTP_SEND;
-        OPMode = WAITING;
-        break;
-    case WHTTP_SEND:
-        tmpTxData = "AT*WHTTP=3\r\n\0";
-        HAL_UART_Transmit(&huart1, (uint8_t *)tmpTxData, strlen(tmpTxData), 0xFFFF);
-        OPModeLast = OPMode;
-        OPModeNext = ACKCHECKING;
-        OPMode = WAITING;
-        break;
-    case ACKCHECKING:
-        HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR30, ++sendingCount);
-        OPModeLast = WHTTP_SEND;
-        OPModeNext = POWEROFF;
-        OPMode = WAITING;
-        break;
-    case SENSING:
-        DEBUG_PRINT("sensing.......\r\n");
-
-        VoltageBAT = 1.2f * 4096.0f / ADCValue[2];
-        VoltageDevice = ADCValue[1] * ADCValue[2] / 4096;
-
-        saveSensingData(sensingCount, (uint32_t *)&VoltageDevice, (uint32_t *)&VoltageBAT, readDINValue());
-
-        sensingCount++;
-        if (sensingCount >= SENSING_TIMES) /* 설정된 센싱 횟수이면 BOOTING 모드로 전환하여 정보 전송 */
-        {
-            OPMode = BOOTING;
-            sensingCount = 0;
-        }
-        else
-        {
-            OPMode = POWEROFF;
-        }
+    uint32_t events = Event_Wait(); /* 처리할 이벤트가 없으면 Sleep 모드, LTE 모뎀 응답 대기 중이면 Stop 모드로 대기 */
 
-        HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR31, (sendFailCount << 16) + sensingCount);
-        break;
-    case POWEROFF:
-        DEBUG_PRINT("POWER OFF\r\n");
-        if (!flag_UserBtnOn) /* 부팅 시 사용자 버튼이 눌리지 않았을 경우 저전력 모드 실행 */
-        {
-            enterStandByMode(WAKEUP_INTERVAL);
-        }
-        break;
-    case TIMEOUT:
-        HAL_RTCEx_BKUPWrite(&hrtc, RTC_BKP_DR31, ((++sendFailCount) << 16) + sensingCount);
-        resendCount = 0;
-        OPMode = POWEROFF;
-        break;
-    case WAITING:
-        if (falg_Answer == true) /* LTE 모뎀의 응답이 있으면 */
+    Timer_Process(); /* 만료된 타이머 콜백 실행 */
+
+    if (events & EVENT_ADC) /* 센싱 값 저장 */
+    {
+        Stage_Set(SENSING);
+    }
+
+    if (Stage_Get() != PASSTHROUGH)
+    {
+        Modem_Process(); /* LTE 모뎀 응답 분석 및 AT 명령 전송 */
+
+        if (events & (EVENT_UART2_RX | EVENT_UART_TX)) /* 송신 버퍼가 차서 남은 데이터는 송신 완료 후 전달 */
         {
-            falg_Answer = false;
-            OPMode = OPModeNext;
+            processDebugPort(); /* 설정 명령 처리, 나머지는 LTE 모뎀으로 전달 */
         }
+    }
+
+    Stage_Process(); /* 운용모드 전환 및 동작 */
+
+    if ((Stage_Get() != PASSTHROUGH) && ((events & EVENT_UART1_RX) == 0U)) /* 처리할 LTE 모뎀 응답이 없을 때만 로그 전송. 남은 로그는 다음 이벤트에서 전송 */
+    {
+        Log_Process();
+    }
+}
+
+/**
+ * @brief BOOTING 진입. LTE 모뎀을 깨우고 전송 데이터 생성. 재전송이면 만들어 둔 전송 데이터를 처음 단계부터 전송.
+ *
+ */
+static void enterBooting(void)
+{
+    HAL_GPIO_WritePin(LTE_WAKEUP_GPIO_Port, LTE_WAKEUP_Pin, GPIO_PIN_SET);
+    Energy_SetLoad(ENERGY_LOAD_MODEM, true);
+    HAL_Delay(100);
+    Retry_SetStep(UPLOAD_ECHO); /* 스탠바이 동안 꺼져 있던 LTE 모뎀은 네트워크 등록부터 다시 확인. 실패 단계부터는 같은 깨어남의 재시도만 */
+    if (!Retry_IsPending())
+    {
+        flushSamples(); /* 백업 레지스터에 모아 둔 값도 전송 */
+        buildUploadData();
+    }
+    Stage_Set(SENDING);
+}
+
+/**
+ * @brief STANDBY 진입. 전환 기록을 출력하고 스탠바이 모드로 들어감.
+ *
+ */
+static void enterStandby(void)
+{
+    Stage_LogTrace();
+    enterStandByMode(Retry_GetWakeInterval(wakeupInterval)); /* 재전송 예약이 있으면 일찍 깨어남 */
+}
+
+/**
+ * @brief POWEROFF 진입. 부팅 시 사용자 버튼이 눌렸으면 제한 시간 동안 깨어 있음.
+ *
+ */
+static void enterPowerOff(void)
+{
+    if (!flag_UserBtnOn) /* 부팅 시 사용자 버튼이 눌리지 않았을 경우 저전력 모드 실행 */
+    {
+        Stage_Set(STANDBY);
+    }
+}
+
+/**
+ * @brief SENSING 진입. ADC 값을 백업 레지스터에 압축 저장하고 설정된 센싱 횟수이면 전송.
+ *        백업 레지스터가 가득 차면 플래시 로그로 옮김.
+ *
+ */
+static void enterSensing(void)
+{
+    sample_TypeDef sample;
+
+    sample.device = ADCValue[1];
+    sample.reference = ADCValue[2];
+    sample.din = readDINValue();
+    LOG_INFO("sensing %u: device %u, reference %u", sensingCount, sample.device, sample.reference);
+
+    if (Pack_Push(&sample) != SUCCESS) /* 가득 참 */
+    {
+        flushSamples();
+        (void)Pack_Push(&sample);
+    }
 
-        if (flag_OpmodeTimeout) /* OPMODE_TIMEOUT 설정 값 안에 LTE 모뎀 응답이 없으면 */
+    sensingCount = (uint16_t)(FlashLog_GetPending() + Pack_GetCount());
+    if (sensingCount >= ((uint32_t)sensingTimes * uploadBatch)) /* 설정된 센싱 횟수이면 BOOTING 모드로 전환하여 정보 전송 */
+    {
+        Retry_Clear(); /* 가장 오래된 값부터 다시 만든 전송 데이터가 대기 중인 전송을 대신함 */
+        Stage_Set(BOOTING);
+    }
+    else if (Retry_IsPending()) /* 센싱 주기에 맞춰 깨어난 재전송 */
+    {
+        Stage_Set(BOOTING);
+    }
+    else
+    {
+        Stage_Set(POWEROFF);
+    }
+
+    HAL_RTCEx_BKUPWrite(&hrtc, BKP_COUNT, (sendFailCount << 16) + sensingCount);
+}
+
+/**
+ * @brief SENDING 진입. 서버 전송 코루틴을 처음부터 시작. 응답 대기 시간 동안 Stop 모드 허용.
+ *
+ */
+static void enterSending(void)
+{
+    Power_EnableStop(true);
+    PT_INIT(&uploadPt);
+}
+
+/**
+ * @brief SENDING 종료. 남은 AT 명령 취소.
+ *
+ */
+static void exitSending(void)
+{
+    Modem_Abort();
+    Energy_SetLoad(ENERGY_LOAD_MODEM_TX, false);
+    Power_EnableStop(false);
+}
+
+/**
+ * @brief SENDING 매 Loop. 서버 전송 코루틴 실행. 코루틴에서 다음 모드 결정.
+ *
+ */
+static void processSending(void)
+{
+    (void)uploadThread(&uploadPt);
+}
+
+/**
+ * @brief ACKCHECKING 진입. 전송 완료 기록. 지난 전송 실패로 밀린 센싱 값이 있으면 모뎀이 켜진 김에 이어서 전송.
+ *
+ */
+static void enterAckChecking(void)
+{
+    HAL_RTCEx_BKUPWrite(&hrtc, BKP_SENDING, ++sendingCount);
+    Retry_Clear();
+    Uart_ClearErrorCount(); /* 전송한 에러 횟수 초기화 */
+    if (FlashLog_Commit(session.firstSeq, session.count) != SUCCESS) /* 기록 실패하면 다음에 다시 전송 */
+    {
+        LOG_ERROR("sensing: flash log commit failed");
+    }
+    session.count = 0U;
+    sensingCount = (uint16_t)(FlashLog_GetPending() + Pack_GetCount());
+    HAL_RTCEx_BKUPWrite(&hrtc, BKP_COUNT, (sendFailCount << 16) + sensingCount);
+
+    if ((sensingCount >= sensingTimes) && (drainCount < UPLOAD_DRAIN_MAX))
+    {
+        drainCount++;
+        Stage_Set(BOOTING);
+    }
+    else
+    {
+        Stage_Set(POWEROFF);
+    }
+}
+
+/**
+ * @brief TIMEOUT 진입. 전송 실패 기록 및 재전송 예약.
+ *
+ */
+static void enterTimeout(void)
+{
+    HAL_RTCEx_BKUPWrite(&hrtc, BKP_COUNT, ((++sendFailCount) << 16) + sensingCount);
+    Retry_Fail(wakeupInterval); /* 재전송 횟수를 넘으면 포기 */
+    Stage_Set(POWEROFF);
+}
+
+/**
+ * @brief PASSTHROUGH 진입. DEBUG 포트는 LTE 모뎀과 연결되므로 부팅 중 쌓인 로그는 버리고 이후 로그도 전송하지 않음.
+ *
+ */
+static void enterPassthrough(void)
+{
+    Log_Discard();
+}
+
+/**
+ * @brief PASSTHROUGH 매 Loop. LTE 모뎀과 DEBUG 포트를 양방향 연결. 모뎀 펌웨어 업데이트, AT 명령 시험용
+ *
+ */
+static void processPassthrough(void)
+{
+    Uart_Forward(&uart1Buffer, &uart2Tx);
+    Uart_Forward(&uart2Buffer, &uart1Tx);
+}
+
+/**
+ * @brief DEBUG 포트 입력 처리. CONFIG_COMMAND 로 시작하는 줄은 설정 명령으로 처리하고, 나머지는
+ *        DEBUG 포트 입력 데이터를 LTE UART 포트로 전송 UART1:LTE모뎀, UART2:DEBUG - 디버그용.
+ *        설정 명령은 부팅 시 사용자 버튼을 눌러 POWEROFF 로 깨어 있는 동안 입력.
+ *
+ */
+static void processDebugPort(void)
+{
+    ring_TypeDef *ring = &uart2Buffer.ring;
+    uartLine_TypeDef line;
+
+    while (Ring_Count(ring) != 0U)
+    {
+        uint16_t count = Ring_Count(ring);
+        uint16_t prefix = (count < (sizeof(CONFIG_COMMAND) - 1U)) ? count : (uint16_t)(sizeof(CONFIG_COMMAND) - 1U);
+
+        for (uint16_t i = 0; i < prefix; i++)
         {
-            flag_OpmodeTimeout = false;
-            resendCount++;
-            if (resendCount >= RETRANSMISSIONS_CNT)
-            {
-                OPMode = TIMEOUT;
-            }
-            else
+            if (Ring_At(ring, (uint16_t)(ring->out + i)) != (uint8_t)CONFIG_COMMAND[i])
             {
-                OPMode = OPModeLast;
-                OPModeLast = WAITING;
+                Uart_Forward(&uart2Buffer, &uart1Tx);
+                return;
             }
-            DEBUG_PRINT("TimeOut\r\n");
         }
-        break;
-    default:
-        break;
+        if (getLineFromBuffer(&uart2Buffer, &line) != SUCCESS) /* 설정 명령이 아직 완성되지 않음 */
+        {
+            return;
+        }
+        handleConfigCommand(&line);
     }
 }
 
+/**
+ * @brief 설정 명령 처리. 저장한 설정은 바로 적용하고 다음 깨어남부터는 Config_Init() 에서 선택됨.
+ *        서버 전송 중에는 AT 명령이 설정을 사용하므로 거부.
+ *
+ * @param line: CONFIG_COMMAND 로 시작하는 한 줄
+ */
+static void handleConfigCommand(const uartLine_TypeDef *line)
+{
+    char text[CONFIG_COMMAND_MAX];
+    uint16_t length = getLineLength(line);
+    config_TypeDef config = *Config_Get();
+
+    if (length >= sizeof(text))
+    {
+        LOG_WARN("config: command too long (%u)", length);
+        return;
+    }
+    for (uint16_t i = 0; i < length; i++)
+    {
+        text[i] = (char)getLineChar(line, i);
+    }
+    text[length] = '\0';
+
+    if (strcmp(text, CONFIG_COMMAND "?") == 0)
+    {
+        LOG_INFO("config: sequence %u, wakeup %u s, timeout %u ms", config.sequence, config.wakeupInterval, config.sendingTimeout);
+        LOG_INFO("config: sensing %u, batch %u, retransmissions %u", config.sensingTimes, config.uploadBatch, config.retransmissions);
+        return;
+    }
+    if ((strncmp(text, CONFIG_COMMAND "=", sizeof(CONFIG_COMMAND)) != 0) || (Config_Parse(&text[sizeof(CONFIG_COMMAND)], &config) != SUCCESS))
+    {
+        LOG_WARN("config: invalid command");
+        return;
+    }
+    if (Stage_Get() == SENDING)
+    {
+        LOG_WARN("config: busy sending");
+        return;
+    }
+    if (Config_Save(&config) == SUCCESS)
+    {
+        applyConfig();
+    }
+}
+
+/**
+ * @brief LED 토글 타이머 콜백
+ *
+ * @param timer: LED 타이머
+ */
+static void onLedTimer(timer_TypeDef *timer)
+{
+    HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin); /* LED 토글 */
+}
+
 /**
  * @brief ADC 완료 인터럽트
  * 
@@ -282,214 +559,235 @@ void userLoop(void)
  */
 void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
 {
-    OPMode = SENSING;
+    Event_Post(EVENT_ADC); /* 운용모드는 사용자 Loop 에서 변경 */
 }
 
 /**
- * @brief LTE 모뎀의 ACK 메시지 분석
- * 
+ * @brief 플래시 설정을 운용모드 표와 서버 전송 AT 명령에 적용. 범위를 벗어난 값은 제한.
+ *
  */
-void ParsingAckMessage(void)
+static void applyConfig(void)
 {
-    char *Query[6] = {"+CPIN", "+CEREG", "*WWANIP", "*WHTTPR", "*WHTTP", "$$MSTIME?"};
-    uint8_t QueryIndex = 0;
+    const config_TypeDef *config = Config_Get();
+    uint8_t retry = (config->retransmissions > 1U) ? (uint8_t)(config->retransmissions - 1U) : 0U;
 
-    char rxMessage[500];
-    memcpy(rxMessage, uart1Buffer.buff, uart1Buffer.count);
-    rxMessage[uart1Buffer.count] = '\0';
-    initBuffer(&uart1Buffer);
-
-    DEBUG_PRINT("*****\r\n%s\r\n*****\r\n", rxMessage);
+    wakeupInterval = config->wakeupInterval;
+    if ((wakeupInterval == 0U) || (wakeupInterval > 0xFFFFU)) /* RTC 깨어남 타이머 16비트 */
+    {
+        wakeupInterval = (wakeupInterval == 0U) ? 1U : 0xFFFFU;
+    }
+    sensingTimes = ((config->sensingTimes >= 1U) && (config->sensingTimes <= CONFIG_SENSING_MAX)) ? config->sensingTimes : CONFIG_SENSING_MAX;
+    uploadBatch = config->uploadBatch; /* 범위는 Config_Parse() 에서 확인 */
+    (void)snprintf(urlCommand, sizeof(urlCommand), "AT*WHTTP=0,POST,%.*s\r\n", (int)(CONFIG_URL_MAX - 1U), config->url);
 
-    for (uint8_t i = 0; i < 6; i++)
+    for (uint8_t step = 0; step < UPLOAD_COMPLETE; step++)
     {
-        if (strstr(rxMessage, Query[i]) != NULL)
-        {
-            QueryIndex = i;
-            DEBUG_PRINT("%s\r\n", Query[i]);
-            break;
-        }
+        uploadScript[step].retry = retry;
     }
+    stageTable[SENDING].timeout = config->sendingTimeout;
+    stageTable[SENDING].retry = retry;
+}
 
-    char *anserString = NULL;
-    switch (QueryIndex)
+/**
+ * @brief 백업 레지스터에 모아 둔 센싱 값을 플래시 로그로 옮김. 쓰기에 실패하면 백업 레지스터에 남겨 두고
+ *        다음에 다시 옮김. 이때 이미 옮긴 값은 중복됨.
+ *
+ */
+static void flushSamples(void)
+{
+    sample_TypeDef samples[FLUSH_CHUNK];
+    uint16_t total = Pack_GetCount();
+
+    for (uint16_t first = 0; first < total; first += FLUSH_CHUNK)
     {
-    case 0: //+CPIN
-        anserString = strtok((char *)rxMessage, "READY");
-        if (anserString != NULL)
-        {
-            falg_Answer = true;
-        }
-        else
-        {
-            falg_Answer = false;
-        }
-        break;
-    case 1: //+CEREG
-        anserString = strtok((char *)rxMessage, "0,1");
-        if (anserString != NULL)
-        {
-            falg_Answer = true;
-        }
-        else
-        {
-            falg_Answer = false;
-        }
-        break;
-    case 2: //*WWANIP
-        anserString = strtok((char *)rxMessage, "2001");
-        if (anserString != NULL)
-        {
-            falg_Answer = true;
-        }
-        else
-        {
-            falg_Answer = false;
-        }
-        break;
-    case 3: //*WHTTPR
-        anserString = strstr((char *)rxMessage, "START");
-        char *anserString2 = strstr((char *)rxMessage, "COMPLETED");
-        if ((anserString != NULL) || (anserString2 != NULL))
-        {
-            falg_Answer = true;
-        }
-        else
-        {
-            falg_Answer = false;
-        }
-        break;
-    case 4: //*WHTTP
-        anserString = strtok((char *)rxMessage, "OK");
-        if (anserString != NULL)
-        {
-            falg_Answer = true;
-        }
-        else
+        uint16_t count = Pack_Read(samples, first, FLUSH_CHUNK);
+
+        for (uint16_t i = 0; i < count; i++)
         {
-            falg_Answer = false;
+            if (FlashLog_Append(&samples[i]) != SUCCESS)
+            {
+                LOG_ERROR("sensing: flash log write failed");
+                return;
+            }
         }
-        break;
-    case 5: //$$MSTIME? 시간 확인
-        break;
-    default:
-        strtok((char *)rxMessage, ":");
-        char *messageType = strtok(NULL, "\r\n"); /* READY */
-        if (messageType != NULL)
-            DEBUG_PRINT("%s\r\n", messageType);
-        break;
     }
+    Pack_Clear();
 }
 
 /**
- * @brief DIN 값 반환
+ * @brief 플래시 로그에서 전송하지 않은 센싱 값을 오래된 것부터 불러와 서버 전송 데이터(AT*WHTTP=2,DATA) 생성.
+ *        Seq 는 첫 센싱 값의 순번으로 서버에서 중복 수신 확인용.
  * 
- * @return uint8_t: [3:0] DIN3~0
  */
-uint8_t readDINValue(void)
+void buildUploadData(void)
 {
-#define DINPORTn 4 /*!< DIN 포트 갯수 */
-    GPIO_TypeDef *DIN_PORT[DINPORTn] = {DIN0_GPIO_Port, DIN1_GPIO_Port, DIN2_GPIO_Port, DIN3_GPIO_Port};
-    const uint16_t DIN_PIN[DINPORTn] = {DIN0_Pin, DIN1_Pin, DIN2_Pin, DIN3_Pin};
-
-    uint8_t DINValue = 0;
-    for (int i = 0; i < DINPORTn; i++)
+    sample_TypeDef samples[CONFIG_SENSING_MAX] = {0};     /*!< 플래시 로그에서 읽은 센싱 값 */
+    uint8_t DINValue[CONFIG_SENSING_MAX] = {0};           /*!< 서버에 보낼 때 데이터 저장용 */
+    float ADCVoltageValue[CONFIG_SENSING_MAX][2] = {{0}}; /*!< 서버에 보낼 때 데이터 저장용 */
+    const uartErrorCount_TypeDef *uartError = Uart_GetErrorCount(); /*!< 지난 전송 이후 LTE 모뎀 UART 에러 횟수 */
+    int length;
+
+    session.count = FlashLog_Read(samples, sensingTimes, &session.firstSeq); /* 전송 중 표시. 서버가 받으면 완료 기록 */
+    for (int i = 0; i < session.count; i++)
     {
-        if (HAL_GPIO_ReadPin(DIN_PORT[i], DIN_PIN[i]) == GPIO_PIN_SET)
+        if (samples[i].reference != 0U)
         {
-            DINValue |= (1 << i);
+            ADCVoltageValue[i][0] = samples[i].device * samples[i].reference / 4096; /* 외부 디바이스 전압 */
+            ADCVoltageValue[i][1] = 1.2f * 4096.0f / samples[i].reference;           /* 배터리 전압 */
         }
+        DINValue[i] = samples[i].din;
+    }
+    length = snprintf(session.data, sizeof(session.data) - 2U, "AT*WHTTP=2,DATA,send=%ld\\&Seq=%lu\\&Fail=%d\\&V1=%.2f\\&V2=%.2f\\&V3=%.2f\\&V4=%.2f\\&V5=%.2f\\&V6=%.2f\\&B1=%.2f\\&B2=%.2f\\&B3=%.2f\\&B4=%.2f\\&B5=%.2f\\&B6=%.2f\\&D1=0x%x\\&D2=0x%x\\&D3=0x%x\\&D4=0x%x\\&D5=0x%x\\&D6=0x%x\\&Ore=%u\\&Fe=%u\\&Ne=%u\\&De=%u", (long)sendingCount, (unsigned long)session.firstSeq, sendFailCount, ADCVoltageValue[0][0], ADCVoltageValue[1][0], ADCVoltageValue[2][0], ADCVoltageValue[3][0], ADCVoltageValue[4][0], ADCVoltageValue[5][0], ADCVoltageValue[0][1], ADCVoltageValue[1][1], ADCVoltageValue[2][1], ADCVoltageValue[3][1], ADCVoltageValue[4][1], ADCVoltageValue[5][1], DINValue[0], DINValue[1], DINValue[2], DINValue[3], DINValue[4], DINValue[5], uartError->overrun, uartError->framing, uartError->noise, uartError->dma);
+    if ((length < 0) || ((size_t)length >= sizeof(session.data) - 2U)) /* 잘렸으면 줄바꿈 자리만 남김 */
+    {
+        length = (length < 0) ? 0 : (int)(sizeof(session.data) - 3U);
     }
+    length += Profile_Print(&session.data[length], sizeof(session.data) - 2U - length); /* 운용모드, AT 명령 소요 시간 */
+    length += Energy_Print(&session.data[length], sizeof(session.data) - 2U - length);  /* 배터리 소모량, 예상 수명 */
+    memcpy(&session.data[length], "\r\n", 3U);
+    Profile_Clear(); /* 보고한 통계 초기화. 다음 전송은 이번 전송 이후 구간 */
+}
 
-    return DINValue;
+/**
+ * @brief +CPIN 응답 확인
+ * 
+ * @param response: +CPIN 응답
+ * @return true: SIM 준비 완료
+ */
+static bool isSimReady(const atResponse_TypeDef *response)
+{
+    return response->param.cpin.ready;
 }
 
 /**
- * @brief 센싱 정보 RTC 백업레지스터에 저장. float형을 uint32으로 변환하여 저장.
+ * @brief +CEREG 응답 확인
  * 
- * @param cntSensing: 센싱 횟수 0~9
- * @param Vdevice: 외부 디바이스 ADC 전압 값
- * @param Vbat: 배터리 ADC 전압 값
+ * @param response: +CEREG 응답
+ * @return true: 네트워크 등록 (홈 또는 로밍)
  */
-void saveSensingData(uint8_t cntSensing, uint32_t *Vdevice, uint32_t *Vbat, uint8_t Din)
+static bool isRegistered(const atResponse_TypeDef *response)
 {
-    HAL_RTCEx_BKUPWrite(&hrtc, cntSensing, *Vdevice);
-    HAL_RTCEx_BKUPWrite(&hrtc, cntSensing + 10U, *Vbat);
-    HAL_RTCEx_BKUPWrite(&hrtc, cntSensing + 20U, (uint32_t)(Din));
+    return (response->param.cereg.stat == 1U) || (response->param.cereg.stat == 5U);
 }
 
 /**
- * @brief 
+ * @brief AT*WHTTP=3 의 *WHTTPR 응답 확인
  * 
- * @param cntSensing: 센싱값 회차 0~9
- * @param Vdevice: 반환될 외부 디바이스 전압 값
- * @param Vbat: 반한될 배터리 전압 값
+ * @param response: *WHTTPR 응답
+ * @return true: 전송 시작 또는 완료
  */
-void loadSensingData(uint8_t cntSensing, uint32_t *Vdevice, uint32_t *Vbat, uint8_t *Din)
+static bool isHttpStarted(const atResponse_TypeDef *response)
 {
-    *Vdevice = HAL_RTCEx_BKUPRead(&hrtc, cntSensing);
-    *Vbat = HAL_RTCEx_BKUPRead(&hrtc, cntSensing + 10U);
-    *Din = (uint8_t)(HAL_RTCEx_BKUPRead(&hrtc, cntSensing + 20U));
+    return (response->param.whttpr.state != AT_HTTP_OTHER) || (response->param.whttpr.status != 0U);
+}
 
-    HAL_RTCEx_BKUPWrite(&hrtc, cntSensing, 0U); /* 읽고 난 후 0으로 초기화 */
-    HAL_RTCEx_BKUPWrite(&hrtc, cntSensing + 10U, 0U);
-    HAL_RTCEx_BKUPWrite(&hrtc, cntSensing + 20U, 0U);
+/**
+ * @brief 전송 완료 *WHTTPR 응답 확인
+ * 
+ * @param response: *WHTTPR 응답
+ * @return true: 전송 완료
+ */
+static bool isHttpCompleted(const atResponse_TypeDef *response)
+{
+    return (response->param.whttpr.state == AT_HTTP_COMPLETED) || (response->param.whttpr.status != 0U);
 }
 
 /**
- * @brief  Timer 인터럽트 함수. 이 함수는 HAL_TIM_IRQHandler() 내부에서 TIM6 인터럽트가 발생했을 때 호출됨.
- * @note   TIM6 - 1ms Timer
+ * @brief 서버가 전송 데이터를 받았는지 확인
  *
- * @param  htim : TIM handle
+ * @param response: *WHTTPR 응답
+ * @return true: HTTP 2xx. 상태 코드가 없으면 받았는지 알 수 없으므로 false
  */
-void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+static bool isHttpAccepted(const atResponse_TypeDef *response)
 {
-    static uint32_t count_1s = 0;
-    static uint32_t count_OpmodeTimeout = 0;
+    return (response->param.whttpr.status >= 200U) && (response->param.whttpr.status <= 299U);
+}
 
-    if (htim->Instance == TIM6) /* 1ms 타이머 인터럽트 */
+/**
+ * @brief 서버 전송 코루틴. 링크 설정 후 AT 명령을 순서대로 보내고 각 응답을 기다림.
+ *        재전송이면 Retry_GetStep() 단계부터 보냄.
+ *
+ * @param pt: 코루틴
+ */
+static PT_THREAD(uploadThread(struct pt *pt))
+{
+    PT_BEGIN(pt);
+
+    PT_SPAWN(pt, &linkPt, Link_Run(&linkPt)); /* 통신 속도 협상 */
+    if (!Link_IsReady())
     {
-        flag_1mSecTimerOn = true;
+        Stage_Fail();
+        PT_EXIT(pt);
+    }
 
-        count_1s++;
-        if (count_1s > 1000) /* 1초 */
-        {
-            flag_1SecTimerOn = true;
-            count_1s = 0;
-        }
+    UPLOAD_STEP(pt, UPLOAD_ECHO);     /* LTE 모뎀의 UART ECHO OFF */
+    UPLOAD_STEP(pt, UPLOAD_SIM);      /* SIM 준비 확인 */
+    UPLOAD_STEP(pt, UPLOAD_REGISTER); /* 네트워크 등록 확인 */
+    UPLOAD_STEP(pt, UPLOAD_ADDRESS);  /* IP 주소 확인 */
+    UPLOAD_STEP(pt, UPLOAD_URL);
+    UPLOAD_STEP(pt, UPLOAD_HEADER);
+    UPLOAD_STEP(pt, UPLOAD_DATA);
+    UPLOAD_STEP(pt, UPLOAD_SEND);
+    Energy_SetLoad(ENERGY_LOAD_MODEM_TX, true); /* 전송 완료까지 송신 전류 */
+    if (!isHttpCompleted(&uploadWait.response)) /* 전송 시작 응답이면 완료 응답 대기 */
+    {
+        UPLOAD_STEP(pt, UPLOAD_COMPLETE);
+    }
 
-        if (uartTimeOutCount == 1) /* UART1 (LTE 모뎀) 데이터 수신 시 10으로 셋팅. */
-        {
-            flag_UartInterruptEnd = true; /* UART 인터럽트가 10ms 이상 없으면 데이터 다 받은 것으로 판단 */
-        }
-        if (uartTimeOutCount)
-        {
-            uartTimeOutCount--;
-        }
+    if (!isHttpAccepted(&uploadWait.response)) /* 서버가 받지 않음. 센싱 값은 플래시 로그에 남기고 다시 전송 */
+    {
+        LOG_WARN("upload rejected: HTTP %u", uploadWait.response.param.whttpr.status);
+        Retry_SetStep(UPLOAD_URL);
+        Stage_Fail();
+        PT_EXIT(pt);
+    }
 
-        if (OPMode == WAITING) /* WAITING 모드에서 타임아웃 설정 */
-        {
-            count_OpmodeTimeout++;
-            if (count_OpmodeTimeout > (OPMODE_TIMEOUT << 10))
-            {
-                flag_OpmodeTimeout = true;
-                count_OpmodeTimeout = 0;
-            }
-        }
-        else if (OPMode == POWEROFF) /* POWEROFF 모드에서 타임아웃 설정 */
-        {
-            count_OpmodeTimeout++;
-            if (count_OpmodeTimeout > 20000)
-            {
-                flag_UserBtnOn = false;
-                count_OpmodeTimeout = 0;
-            }
-        }
-        else
+    LOG_INFO("upload completed: HTTP %u", uploadWait.response.param.whttpr.status);
+    Stage_Set(ACKCHECKING);
+    PT_END(pt);
+}
+
+/**
+ * @brief 서버 전송 단계 결과 확인. 실패하면 다음 시도의 시작 단계를 기록하고 운용모드 실패.
+ *
+ * @param step: 완료된 단계
+ * @return true: 성공
+ */
+static bool checkUploadStep(uint8_t step)
+{
+    if (uploadWait.result != MODEM_RESULT_OK) /* 재전송 후에도 실패 */
+    {
+        LOG_WARN("upload step %u failed: result %u, response %u", step, uploadWait.result, uploadWait.response.type);
+        Retry_SetStep((step > UPLOAD_URL) ? UPLOAD_URL : step);
+        Stage_Fail(); /* 재시도 횟수가 남아 있으면 재시도 간격 후 실패한 단계부터 다시 전송 */
+        return false;
+    }
+
+    Profile_Command(step, Modem_GetRoundTrip());
+    return true;
+}
+
+/**
+ * @brief DIN 값 반환
+ * 
+ * @return uint8_t: [3:0] DIN3~0
+ */
+uint8_t readDINValue(void)
+{
+#define DINPORTn 4 /*!< DIN 포트 갯수 */
+    GPIO_TypeDef *DIN_PORT[DINPORTn] = {DIN0_GPIO_Port, DIN1_GPIO_Port, DIN2_GPIO_Port, DIN3_GPIO_Port};
+    const uint16_t DIN_PIN[DINPORTn] = {DIN0_Pin, DIN1_Pin, DIN2_Pin, DIN3_Pin};
+
+    uint8_t DINValue = 0;
+    for (int i = 0; i < DINPORTn; i++)
+    {
+        if (HAL_GPIO_ReadPin(DIN_PORT[i], DIN_PIN[i]) == GPIO_PIN_SET)
         {
-            count_OpmodeTimeout = 0;
+            DINValue |= (1 << i);
         }
     }
+
+    return DINValue;
 }
 
 /**
@@ -516,6 +814,18 @@ void enterStandByMode(uint32_t delaySec)
     __HAL_PWR_CLEAR_FLAG(PWR_FLAG_WU);
     HAL_RTCEx_SetWakeUpTimer_IT(&hrtc, delaySec, RTC_WAKEUPCLOCK_CK_SPRE_16BITS, 0);
 
-    /* 스탠바이 모드 진입 */
+    LOG_INFO("standby %u s", delaySec);
+
+    /* 로그 및 송신 버퍼에 남은 데이터 전송 완료 대기 */
+    while (!Log_IsEmpty() || !Uart_IsTxIdle(&uart1Tx) || !Uart_IsTxIdle(&uart2Tx))
+    {
+        Log_Process();
+        (void)Event_Wait(); /* 송신 완료까지 Sleep */
+    }
+
+    Energy_EnterStandby(delaySec); /* 누적 전하량 저장 */
+
+    /* 스탠바이 모드 진입. SRAM2 (.retained 섹션) 유지 */
+    Retain_EnterStandby();
     HAL_PWR_EnterSTANDBYMode();
 }